@@ -0,0 +1,198 @@
+#include "generator.hh"
+
+static const constexpr usize IdConstCount = 64;
+static const constexpr usize BlobCount    = 4;
+static const constexpr usize BlobSize     = 1024;
+
+// public
+const std::vector<Bench::Mix> &Bench::Generator::AllMixes() {
+	static const std::vector<Mix> mixes = {
+		Mix::Strings,
+		Mix::Ids,
+		Mix::Ints,
+		Mix::Consts,
+		Mix::Comments,
+		Mix::Mixed
+	};
+
+	return mixes;
+};
+
+const char *Bench::Generator::MixName(const Mix p_mix) {
+	switch (p_mix) {
+	case Mix::Strings:  return "strings";
+	case Mix::Ids:      return "ids";
+	case Mix::Ints:     return "ints";
+	case Mix::Consts:   return "consts";
+	case Mix::Comments: return "comments";
+	case Mix::Mixed:    return "mixed";
+
+	default: return "unknown";
+	};
+};
+
+bool Bench::Generator::MixFromName(const std::string &p_name, Mix &p_mix) {
+	for (const Mix mix : AllMixes()) {
+		if (p_name == MixName(mix)) {
+			p_mix = mix;
+
+			return true;
+		};
+	};
+
+	return false;
+};
+
+Bench::Generator::Generator(const u64 p_seed):
+	m_state(p_seed == 0? 1 : p_seed)
+{};
+
+Bench::Workload Bench::Generator::Generate(const Mix p_mix, const usize p_size) {
+	Workload workload;
+	workload.name  = MixName(p_mix);
+	workload.calls = 0;
+	workload.funcs = {"call"};
+
+	AddConsts(workload);
+
+	while (workload.code.size() < p_size) {
+		Mix mix = p_mix;
+		if (mix == Mix::Mixed)
+			mix = static_cast<Mix>(Range(0, static_cast<usize>(Mix::Comments)));
+
+		switch (mix) {
+		case Mix::Strings:  EmitStrings(workload);  break;
+		case Mix::Ids:      EmitIds(workload);      break;
+		case Mix::Ints:     EmitInts(workload);     break;
+		case Mix::Consts:   EmitConsts(workload);   break;
+		case Mix::Comments: EmitComments(workload); break;
+
+		default: break;
+		};
+	};
+
+	return workload;
+};
+
+// private
+u64 Bench::Generator::Next() {
+	// xorshift64, deterministic across platforms
+	m_state ^= m_state << 13;
+	m_state ^= m_state >> 7;
+	m_state ^= m_state << 17;
+
+	return m_state;
+};
+
+usize Bench::Generator::Range(const usize p_min, const usize p_max) {
+	return p_min + static_cast<usize>(Next() % (p_max - p_min + 1));
+};
+
+void Bench::Generator::EmitStrings(Workload &p_workload) {
+	static const char *escapes[] = {"\\n", "\\t", "\\\\", "\\\""};
+
+	std::string &code = p_workload.code;
+
+	code += "call \"";
+	const usize length = Range(64, 512);
+	for (usize i = 0; i < length; ++ i) {
+		if (Range(0, 31) == 0)
+			code += escapes[Range(0, 3)];
+		else
+			code += static_cast<char>(Range('a', 'z'));
+	};
+
+	code += "\"\n";
+	++ p_workload.calls;
+};
+
+void Bench::Generator::EmitIds(Workload &p_workload) {
+	std::string &code = p_workload.code;
+
+	code += "call";
+	const usize count = Range(4, 16);
+	for (usize i = 0; i < count; ++ i)
+		code += " id_const_" + std::to_string(Range(0, IdConstCount - 1));
+
+	code += '\n';
+	++ p_workload.calls;
+};
+
+void Bench::Generator::EmitInts(Workload &p_workload) {
+	static const u8 sizes[] = {1, 2, 4, 8};
+
+	std::string &code = p_workload.code;
+
+	code += "call";
+	const usize count = Range(4, 16);
+	for (usize i = 0; i < count; ++ i) {
+		code += ' ';
+
+		// Keep the value in range of its size, 4 bytes being the default
+		const u8 size = sizes[Range(0, 3)];
+		const u64 value = size == 8? Next() : Next() & ((1ull << (size * 8)) - 1);
+		if (Range(0, 1) == 0)
+			code += std::to_string(value);
+		else {
+			static const char digits[] = "0123456789ABCDEF";
+
+			code += '$';
+			for (u8 shift = size * 8; shift > 0; shift -= 4)
+				code += digits[(value >> (shift - 4)) & 0xF];
+		};
+
+		if (size != 4)
+			code += ':' + std::to_string(size);
+	};
+
+	code += '\n';
+	++ p_workload.calls;
+};
+
+void Bench::Generator::EmitConsts(Workload &p_workload) {
+	std::string &code = p_workload.code;
+
+	code += "call";
+	const usize count = Range(1, 4);
+	for (usize i = 0; i < count; ++ i)
+		code += " BLOB" + std::to_string(Range(0, BlobCount - 1));
+
+	code += '\n';
+	++ p_workload.calls;
+};
+
+void Bench::Generator::EmitComments(Workload &p_workload) {
+	std::string &code = p_workload.code;
+
+	const usize length = Range(32, 256);
+	std::string text;
+	for (usize i = 0; i < length; ++ i)
+		text += Range(0, 7) == 0? ' ' : static_cast<char>(Range('a', 'z'));
+
+	switch (Range(0, 2)) {
+	case 0: code += "# "  + text + '\n'; break;
+	case 1: code += "// " + text + '\n'; break;
+
+	default:
+		code += "/* " + text + "\n   " + text + " */ call 1:1\n";
+		++ p_workload.calls;
+
+		break;
+	};
+};
+
+void Bench::Generator::AddConsts(Workload &p_workload) {
+	for (usize i = 0; i < IdConstCount; ++ i)
+		p_workload.consts.push_back({
+			"id_const_" + std::to_string(i),
+			SCBL::Const(i, SCBL::Const::Size8b)
+		});
+
+	for (usize i = 0; i < BlobCount; ++ i) {
+		std::string blob;
+		for (usize j = 0; j < BlobSize; ++ j)
+			blob += static_cast<char>(Range('A', 'Z'));
+
+		p_workload.consts.push_back({"BLOB" + std::to_string(i), SCBL::Const(blob)});
+	};
+};
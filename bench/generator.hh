@@ -0,0 +1,63 @@
+#ifndef __GENERATOR_HH_HEADER_GUARD__
+#define __GENERATOR_HH_HEADER_GUARD__
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include <utility> // std::pair
+#include <scbl.hh> // SCBL::Const, SCBL::u8, SCBL::u64, SCBL::usize
+
+using SCBL::u8;
+using SCBL::u64;
+using SCBL::usize;
+
+namespace Bench {
+	// Kinds of synthetic scripts the generator can build
+	enum class Mix : u8 {
+		Strings,  // Long string literals with escapes
+		Ids,      // Many constant identifiers per call
+		Ints,     // Wide decimal and hex integers with size specifiers
+		Consts,   // Calls referencing large constants
+		Comments, // Mostly single and multi line comments
+		Mixed     // All of the above interleaved
+	}; // enum class Mix
+
+	struct Workload {
+	public:
+		std::string name;
+		std::string code;
+
+		usize calls; // Amount of function calls in the code
+
+		// Functions and constants the code expects to be set
+		std::vector<std::string> funcs;
+		std::vector<std::pair<std::string, SCBL::Const>> consts;
+	}; // struct Workload
+
+	class Generator {
+	public:
+		static const std::vector<Mix> &AllMixes();
+		static const char *MixName(const Mix p_mix);
+		static bool MixFromName(const std::string &p_name, Mix &p_mix);
+
+		Generator(const u64 p_seed = 0x5CB12);
+
+		// Builds a script of about p_size bytes
+		Workload Generate(const Mix p_mix, const usize p_size);
+
+	private:
+		u64 Next();
+		usize Range(const usize p_min, const usize p_max);
+
+		void EmitStrings (Workload &p_workload);
+		void EmitIds     (Workload &p_workload);
+		void EmitInts    (Workload &p_workload);
+		void EmitConsts  (Workload &p_workload);
+		void EmitComments(Workload &p_workload);
+
+		void AddConsts(Workload &p_workload);
+
+		u64 m_state;
+	}; // class Generator
+}; // namespace Bench
+
+#endif // __GENERATOR_HH_HEADER_GUARD__
@@ -0,0 +1,636 @@
+#include <iostream> // std::cout, std::cerr
+#include <chrono> // std::chrono::steady_clock
+#include <cstdlib> // std::strtoull
+#include <memory_resource> // std::pmr::monotonic_buffer_resource
+#include <sstream> // std::ostringstream
+#include <iomanip> // std::setw, std::setfill
+#include "generator.hh"
+
+/*
+ *  SCBL benchmarks
+ *
+ *  Measures the lexer, compiler, environment and parameter handler on
+ *  synthetic workloads. Results are printed as CSV, one row per stage
+ *  and workload:
+ *
+ *    bench,mix,bytes,calls,iters,seconds,bytes_per_sec,calls_per_sec
+ *
+ *  bytes and calls are per iteration. For the lex, compile and run
+ *  stages calls are the function calls in the script, for the params
+ *  stage they are the GetNextParam* calls. The params_native stage
+ *  decodes the same frames in the native aligned layout, the
+ *  params_typed stage reads them by index from typed parameters. The
+ *  lex_parallel stage lexes on all the cores (or --threads). The
+ *  run_cached stage runs through the parameter cache, which is filled
+ *  by a run before it. It has to be at least as fast as the run stage,
+ *  otherwise the benchmark fails. The run_segments stage calls a segment callback,
+ *  so constants are not copied. The run_batch stage calls a batch
+ *  callback once for many calls. The run_traced stage is the run stage
+ *  with the call trace enabled. The run_set_consts stage sets every
+ *  constant before each cached run, the run_lazy_consts stage makes
+ *  them lazy, once per run. The pipeline_arena stage is the pipeline
+ *  with the lexer and compiler allocating from a monotonic buffer
+ *  which is released after each iteration. The command_format
+ *  stage lexes, compiles and runs one formatted command per call, the
+ *  command_prepared stage binds the arguments of a compiled one. The
+ *  command_repeat stage does the same as command_format with a few
+ *  repeated commands, the command_eval stage runs them through Eval,
+ *  which keeps them compiled. The result_const and result_register
+ *  stages run calls which each use the result of the one before, kept
+ *  in a constant or in a register. The call_dynamic and call_static
+ *  stages run the same cached calls of a function set with SetFunc and
+ *  of a function of a StaticEnvironment. The format and format_pure
+ *  stages format a few numbers again and again, with the function
+ *  called every time or once for each number. After them, pure
+ *  functions with a segment or batch callback have to be refused,
+ *  otherwise the benchmark fails.
+ */
+
+static volatile u64 g_sink; // Keeps the callbacks from being optimized out
+
+static void SCBLf_call(const SCBL::ParamView p_params, void *_) {
+	g_sink = g_sink + p_params.Size();
+};
+
+static void SCBLf_callSegments(const SCBL::ParamSegments p_params, void *_) {
+	g_sink = g_sink + p_params.Bytes();
+};
+
+static void SCBLf_callBatch(const SCBL::ParamFrames p_params, void *_) {
+	g_sink = g_sink + p_params.Bytes();
+};
+
+// Adds 1 to its parameter and keeps it in result, like the example
+static void SCBLf_incConst(const SCBL::ParamView p_params, void *p_env) {
+	SCBL::Tools::ParamHandler phandle(p_params);
+
+	u64 num = 0;
+	phandle.TryGetNextParam64(num);
+	static_cast<SCBL::Environment*>(p_env)->SetConst("result", SCBL::Const(num + 1, SCBL::Const::Size64b));
+};
+
+static usize g_result; // Register of SCBLf_incRegister
+
+static void SCBLf_incRegister(const SCBL::ParamView p_params, void *p_env) {
+	SCBL::Tools::ParamHandler phandle(p_params);
+
+	u64 num = 0;
+	phandle.TryGetNextParam64(num);
+	static_cast<SCBL::Environment*>(p_env)->SetRegister(g_result, num + 1);
+};
+
+// SCBLf_call as a function of a StaticEnvironment
+struct StaticCall {
+public:
+	static constexpr const char *Name = "call";
+
+	static void Call(const SCBL::ParamView p_params, u64 &p_sink) {
+		p_sink += p_params.Size();
+	};
+}; // struct StaticCall
+
+// Sets result to its parameter formatted as hexadecimal bytes
+static void SCBLf_format(const SCBL::ParamView p_params, void *p_env) {
+	SCBL::Tools::ParamHandler phandle(p_params);
+
+	u64 num = 0;
+	phandle.TryGetNextParamInt(num);
+
+	std::ostringstream text;
+	text << std::hex << std::setfill('0');
+	for (usize i = 0; i < 4; ++ i)
+		text << (i > 0? " " : "") << std::setw(2) << (num >> ((3 - i) * 010) & 0xFF);
+
+	static_cast<SCBL::Environment*>(p_env)->SetRegister(g_result, text.str());
+};
+
+struct Options {
+public:
+	usize size  = 1 << 20;
+	usize iters = 5;
+	usize threads = 0; // Threads of the lex_parallel stage, 0 for all the cores
+	u64   seed  = 0x5CB12;
+
+	std::vector<Bench::Mix> mixes;
+	bool params = true;
+}; // struct Options
+
+template <typename T>
+static double Time(const usize p_iters, T p_func) {
+	const auto start = std::chrono::steady_clock::now();
+	for (usize i = 0; i < p_iters; ++ i)
+		p_func();
+
+	const std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	return elapsed.count();
+};
+
+static void Report(
+	const char *p_bench,
+	const std::string &p_mix,
+	const usize p_bytes,
+	const usize p_calls,
+	const usize p_iters,
+	const double p_seconds
+) {
+	const double seconds = p_seconds > 0? p_seconds : 1e-9;
+
+	std::cout
+		<< p_bench << ","
+		<< p_mix << ","
+		<< p_bytes << ","
+		<< p_calls << ","
+		<< p_iters << ","
+		<< p_seconds << ","
+		<< static_cast<u64>(p_bytes * p_iters / seconds) << ","
+		<< static_cast<u64>(p_calls * p_iters / seconds)
+		<< std::endl;
+};
+
+// False if the parameter cache made the runs slower
+static bool BenchWorkload(const Bench::Workload &p_workload, const Options &p_options) {
+	SCBL::Lexer scbll;
+	SCBL::Compiler scblc;
+	SCBL::Environment scble;
+
+	for (const std::string &func : p_workload.funcs)
+		scble.SetFunc(func, SCBL::Func(SCBLf_call));
+
+	for (const auto &constant : p_workload.consts)
+		scble.SetConst(constant.first, constant.second);
+
+	const usize bytes = p_workload.code.size();
+
+	double seconds = Time(p_options.iters, [&]() {
+		scbll.Lex(p_workload.code);
+	});
+	Report("lex", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	seconds = Time(p_options.iters, [&]() {
+		scbll.LexParallel(p_workload.code, p_options.threads);
+	});
+	Report("lex_parallel", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	seconds = Time(p_options.iters, [&]() {
+		scblc.Compile(scbll.GetTokens());
+	});
+	Report("compile", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc.GetStructcode());
+	});
+	Report("run", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	const double uncached = seconds;
+
+	scble.Run(scblc);
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc);
+	});
+	Report("run_cached", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	const bool cached = seconds <= uncached;
+	if (not cached)
+		std::cerr
+			<< "bench: run_cached is slower than run on the "
+			<< p_workload.name << " workload"
+			<< std::endl;
+
+	for (const std::string &func : p_workload.funcs)
+		scble.SetFunc(func, SCBL::Func(SCBLf_callSegments));
+
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc.GetStructcode());
+	});
+	Report("run_segments", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	// The callback does not set constants, so every call is batched
+	for (const std::string &func : p_workload.funcs)
+		scble.SetFunc(func, SCBL::Func(SCBLf_callBatch, true));
+
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc.GetStructcode());
+	});
+	Report("run_batch", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	for (const std::string &func : p_workload.funcs)
+		scble.SetFunc(func, SCBL::Func(SCBLf_call));
+
+	scble.EnableTrace();
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc.GetStructcode());
+	});
+	scble.DisableTrace();
+	Report("run_traced", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	// The host pushes every value before the run, used or not
+	seconds = Time(p_options.iters, [&]() {
+		for (const auto &constant : p_workload.consts)
+			scble.SetConst(constant.first, constant.second);
+
+		scble.Run(scblc);
+	});
+	Report("run_set_consts", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	// The values are only made when a call uses them, once per run
+	for (const auto &constant : p_workload.consts) {
+		const SCBL::Const value = constant.second;
+		scble.SetConst(constant.first, SCBL::Const::Lazy([value](void *_) {
+			return value;
+		}, true));
+	};
+
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc);
+	});
+	Report("run_lazy_consts", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	for (const auto &constant : p_workload.consts)
+		scble.SetConst(constant.first, constant.second);
+
+	seconds = Time(p_options.iters, [&]() {
+		scbll.Lex(p_workload.code);
+		scblc.Compile(scbll.GetTokens());
+		scble.Run(scblc.GetStructcode());
+	});
+	Report("pipeline", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	// Big enough for the token and structcode vectors to grow in
+	// without going back to the heap
+	std::vector<u8> buffer(bytes * 64);
+	std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+	seconds = Time(p_options.iters, [&]() {
+		{
+			SCBL::Lexer arenaLexer(&arena);
+			SCBL::Compiler arenaCompiler(&arena);
+
+			arenaLexer.Lex(p_workload.code);
+			arenaCompiler.Compile(arenaLexer);
+			scble.Run(arenaCompiler.GetStructcode());
+		};
+
+		arena.release();
+	});
+	Report("pipeline_arena", p_workload.name, bytes, p_workload.calls, p_options.iters, seconds);
+
+	return cached;
+};
+
+static void BenchParams(const Options &p_options) {
+	// One frame is an 8, 16, 32 and 64 bit integer followed by a string
+	static const std::vector<u8> frame = {
+		0x12,
+		0x12, 0x34,
+		0x12, 0x34, 0x56, 0x78,
+		0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE, 0xF0,
+		'p', 'a', 'r', 'a', 'm', 'e', 't', 'e', 'r', 0
+	};
+	static const constexpr usize decodesPerFrame = 5;
+
+	std::vector<u8> params;
+	while (params.size() < p_options.size)
+		params.insert(params.end(), frame.begin(), frame.end());
+
+	const usize frames = params.size() / frame.size();
+
+	const double seconds = Time(p_options.iters, [&]() {
+		SCBL::Tools::ParamHandler phandle(params);
+
+		for (usize i = 0; i < frames; ++ i) {
+			u64 sum = phandle.GetNextParam8();
+			sum += phandle.GetNextParam16();
+			sum += phandle.GetNextParam32();
+			sum += phandle.GetNextParam64();
+			sum += phandle.GetNextParamStr().size();
+
+			g_sink = g_sink + sum;
+		};
+	});
+
+	Report(
+		"params", "frames", params.size(), frames * decodesPerFrame,
+		p_options.iters, seconds
+	);
+
+	// The same frames in the native layout, each integer aligned to its size
+	std::vector<u8> native;
+	usize nativeFrames = 0;
+	for (; native.size() < p_options.size; ++ nativeFrames) {
+		static const u8 sizes[] = {1, 2, 4, 8};
+		for (const u8 size : sizes) {
+			native.resize(SCBL::Tools::AlignUp(native.size(), size) + size);
+			SCBL::Tools::StoreNative(0x12345678, size, native.data() + native.size() - size);
+		};
+
+		native.insert(native.end(), frame.end() - 10, frame.end());
+	};
+
+	const double nativeSeconds = Time(p_options.iters, [&]() {
+		SCBL::Tools::ParamHandler phandle(native, SCBL::Layout::Native);
+
+		for (usize i = 0; i < nativeFrames; ++ i) {
+			u64 sum = phandle.GetNextParam8();
+			sum += phandle.GetNextParam16();
+			sum += phandle.GetNextParam32();
+			sum += phandle.GetNextParam64();
+			sum += phandle.GetNextParamStr().size();
+
+			g_sink = g_sink + sum;
+		};
+	});
+
+	Report(
+		"params_native", "frames", native.size(), nativeFrames * decodesPerFrame,
+		p_options.iters, nativeSeconds
+	);
+
+	// The same frames as the arguments of one call of typed code
+	std::string code = "capture";
+	for (usize i = 0; i < frames; ++ i)
+		code += " $12:1 $1234:2 $12345678 $123456789ABCDEF0:8 \"parameter\"";
+
+	std::vector<u8> typed;
+	SCBL::Lexer scbll;
+	SCBL::Compiler scblc;
+	SCBL::Environment scble;
+	scble.SetFunc("capture", SCBL::Func(SCBL::Callback([&typed](const SCBL::ParamView p_params, void *_) {
+		typed.assign(p_params.begin(), p_params.end());
+	})));
+
+	scblc.SetTyped(true);
+	scbll.Lex(code);
+	scblc.Compile(scbll);
+	scble.Run(scblc.GetStructcode());
+
+	const double typedSeconds = Time(p_options.iters, [&]() {
+		SCBL::Tools::ParamHandler phandle(typed);
+		phandle.TryReadArgs();
+
+		for (usize i = 0; i < phandle.GetArgCount(); i += decodesPerFrame) {
+			u64 sum = phandle.GetArgInt(i);
+			sum += phandle.GetArgInt(i + 1);
+			sum += phandle.GetArgInt(i + 2);
+			sum += phandle.GetArgInt(i + 3);
+			sum += phandle.GetArgView(i + 4).Size();
+
+			g_sink = g_sink + sum;
+		};
+	});
+
+	Report(
+		"params_typed", "frames", typed.size(), frames * decodesPerFrame,
+		p_options.iters, typedSeconds
+	);
+};
+
+// False if a pure function without a callback was taken
+static bool BenchCommands(const Options &p_options) {
+	// Commands of the same shape with different arguments
+	const usize commands = p_options.size / 256 + 1;
+
+	SCBL::Lexer scbll;
+	SCBL::Compiler scblc;
+	SCBL::Environment scble;
+	scble.SetFunc("call", SCBL::Func(SCBLf_call));
+
+	double seconds = Time(p_options.iters, [&]() {
+		for (usize i = 0; i < commands; ++ i) {
+			scbll.Lex("call " + std::to_string(i) + " \"item_" + std::to_string(i) + "\"");
+			scblc.Compile(scbll);
+			scble.Run(scblc.GetStructcode());
+		};
+	});
+	Report("command_format", "commands", 0, commands, p_options.iters, seconds);
+
+	scbll.Lex("call @1 @2");
+	scblc.Compile(scbll);
+	SCBL::Bindings bindings(scblc);
+
+	seconds = Time(p_options.iters, [&]() {
+		for (usize i = 0; i < commands; ++ i) {
+			bindings.Bind(0, SCBL::Const(i));
+			bindings.Bind(1, SCBL::Const("item_" + std::to_string(i)));
+			scble.Run(scblc, bindings);
+		};
+	});
+	Report("command_prepared", "commands", 0, commands, p_options.iters, seconds);
+
+	// Most commands are one of a few
+	std::vector<std::string> repeated;
+	for (usize i = 0; i < 16; ++ i)
+		repeated.push_back("call " + std::to_string(i) + " \"item_" + std::to_string(i) + "\"");
+
+	seconds = Time(p_options.iters, [&]() {
+		for (usize i = 0; i < commands; ++ i) {
+			scbll.Lex(repeated[i % repeated.size()]);
+			scblc.Compile(scbll);
+			scble.Run(scblc.GetStructcode());
+		};
+	});
+	Report("command_repeat", "commands", 0, commands, p_options.iters, seconds);
+
+	seconds = Time(p_options.iters, [&]() {
+		for (usize i = 0; i < commands; ++ i)
+			scble.Eval(repeated[i % repeated.size()]);
+	});
+	Report("command_eval", "commands", 0, commands, p_options.iters, seconds);
+
+	// Every call uses the result of the one before it
+	std::string chain = "inc 0:8\n";
+	for (usize i = 1; i < commands; ++ i)
+		chain += "inc result\n";
+
+	scbll.Lex(chain);
+	scblc.Compile(scbll);
+
+	SCBL::Environment chained;
+	chained.SetUserData(&chained);
+	chained.SetFunc("inc", SCBL::Func(SCBLf_incConst));
+	chained.SetConst("result", SCBL::Const(0, SCBL::Const::Size64b));
+
+	seconds = Time(p_options.iters, [&]() {
+		chained.Run(scblc.GetStructcode());
+	});
+	Report("result_const", "commands", 0, commands, p_options.iters, seconds);
+
+	chained.SetFunc("inc", SCBL::Func(SCBLf_incRegister));
+	g_result = chained.AddRegister("result");
+
+	seconds = Time(p_options.iters, [&]() {
+		chained.Run(scblc.GetStructcode());
+	});
+	Report("result_register", "commands", 0, commands, p_options.iters, seconds);
+
+	std::string calls;
+	for (usize i = 0; i < commands; ++ i)
+		calls += "call 1 2\n";
+
+	scbll.Lex(calls);
+	scblc.Compile(scbll);
+
+	seconds = Time(p_options.iters, [&]() {
+		scble.Run(scblc);
+	});
+	Report("call_dynamic", "commands", 0, commands, p_options.iters, seconds);
+
+	u64 sink = 0;
+	SCBL::StaticEnvironment<u64, StaticCall> statics(sink);
+
+	seconds = Time(p_options.iters, [&]() {
+		statics.Run(scblc);
+	});
+	g_sink = g_sink + sink;
+	Report("call_static", "commands", 0, commands, p_options.iters, seconds);
+
+	// Formatting of a few numbers, again and again
+	std::string formats;
+	for (usize i = 0; i < commands; ++ i)
+		formats += "format " + std::to_string(i % 16 * 1000003) + "\n";
+
+	scbll.Lex(formats);
+	scblc.Compile(scbll);
+
+	chained.SetFunc("format", SCBL::Func(SCBLf_format));
+	seconds = Time(p_options.iters, [&]() {
+		chained.Run(scblc);
+	});
+	Report("format", "commands", 0, commands, p_options.iters, seconds);
+
+	chained.SetFunc("format", SCBL::Func::Pure(SCBLf_format));
+	seconds = Time(p_options.iters, [&]() {
+		chained.Run(scblc);
+	});
+	Report("format_pure", "commands", 0, commands, p_options.iters, seconds);
+
+	// Only the callback is memoized, so segment and batch ones can not be pure
+	SCBL::Func segments(SCBLf_callSegments), batch(SCBLf_callBatch);
+	segments.pure = true;
+	batch.pure    = true;
+
+	const bool rejected =
+		chained.TrySetFunc("format", segments).code == SCBL::ErrorCode::InvalidPureFunc and
+		chained.TrySetFunc("format", batch).code    == SCBL::ErrorCode::InvalidPureFunc;
+	if (not rejected)
+		std::cerr << "bench: A pure function without a callback was set" << std::endl;
+
+	return rejected;
+};
+
+static bool ReadOptions(const int p_argc, const char *p_argv[], Options &p_options) {
+	for (int i = 1; i < p_argc; ++ i) {
+		const std::string arg = p_argv[i];
+
+		if (arg == "-h" or arg == "--help") {
+			std::cout
+				<< "Usage: bench [Options]\n"
+				<< "Options:\n"
+				<< "    -h, --help         Show the usage\n"
+				<< "    -s, --size BYTES   Size of each generated script (default 1048576)\n"
+				<< "    -i, --iters N      Iterations of each benchmark (default 5)\n"
+				<< "    -t, --threads N    Threads of the lex_parallel benchmark (default all the cores)\n"
+				<< "    -m, --mix NAME     Only run the given workload, can be repeated\n"
+				<< "                       (strings, ids, ints, consts, comments, mixed)\n"
+				<< "        --seed N       Seed of the workload generator\n"
+				<< "        --no-params    Skip the parameter handler benchmark"
+				<< std::endl;
+
+			return false;
+		};
+
+		if (arg == "--no-params") {
+			p_options.params = false;
+
+			continue;
+		};
+
+		if (i + 1 >= p_argc) {
+			std::cerr << "bench: Missing value for '" << arg << "'" << std::endl;
+
+			return false;
+		};
+
+		const std::string value = p_argv[++ i];
+		if (arg == "-s" or arg == "--size")
+			p_options.size = std::strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-i" or arg == "--iters")
+			p_options.iters = std::strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-t" or arg == "--threads")
+			p_options.threads = std::strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "--seed")
+			p_options.seed = std::strtoull(value.c_str(), nullptr, 10);
+		else if (arg == "-m" or arg == "--mix") {
+			Bench::Mix mix;
+			if (not Bench::Generator::MixFromName(value, mix)) {
+				std::cerr << "bench: Unknown workload '" << value << "'" << std::endl;
+
+				return false;
+			};
+
+			p_options.mixes.push_back(mix);
+		} else {
+			std::cerr << "bench: Unknown option '" << arg << "'" << std::endl;
+
+			return false;
+		};
+	};
+
+	if (p_options.mixes.empty())
+		p_options.mixes = Bench::Generator::AllMixes();
+
+	if (p_options.iters == 0)
+		p_options.iters = 1;
+
+	return true;
+};
+
+int main(const int argc, const char *argv[]) {
+	Options options;
+	if (not ReadOptions(argc, argv, options))
+		return 1;
+
+	std::cout << "bench,mix,bytes,calls,iters,seconds,bytes_per_sec,calls_per_sec" << std::endl;
+
+	bool passed = true;
+	try {
+		for (const Bench::Mix mix : options.mixes) {
+			Bench::Generator generator(options.seed);
+
+			if (not BenchWorkload(generator.Generate(mix, options.size), options))
+				passed = false;
+		};
+
+		if (options.params)
+			BenchParams(options);
+
+		if (not BenchCommands(options))
+			passed = false;
+	} catch (const SCBL::CompilerException &error) {
+		std::cerr
+			<< "bench:" << error.Line()
+			<< ":" << error.Col()
+			<< ": error:\n  "
+			<< error.What()
+			<< std::endl;
+
+		return 1;
+	} catch (const SCBL::RuntimeException &error) {
+		std::cerr
+			<< "bench:" << error.Idx()
+			<< ": error:\n  "
+			<< error.What()
+			<< std::endl;
+
+		return 1;
+	} catch (const SCBL::Exception &error) {
+		std::cerr
+			<< "bench: error:\n  "
+			<< error.What()
+			<< std::endl;
+
+		return 1;
+	};
+
+	return passed? 0 : 1;
+};
@@ -1,12 +1,30 @@
 #include "app.hh"
 
 // public
-Example::App::App() {
+Example::App::App():
+	m_result(0),
+	m_exitCode(0),
+	m_memStats(false),
+	m_typed(false),
+	m_stream(false),
+	m_watch(false),
+	m_jobs(1),
+	m_out(&std::cout),
+	m_err(&std::cerr)
+{
 	Init();
 };
 
-Example::App::App(const u8 p_argc, const char *p_argv[]):
-	m_exitCode(0)
+Example::App::App(const int p_argc, const char *p_argv[]):
+	m_result(0),
+	m_exitCode(0),
+	m_memStats(false),
+	m_typed(false),
+	m_stream(false),
+	m_watch(false),
+	m_jobs(1),
+	m_out(&std::cout),
+	m_err(&std::cerr)
 {
 	Init();
 	Start(p_argc, p_argv);
@@ -18,36 +36,135 @@ u8 Example::App::GetExitcode() const {
 	return m_exitCode;
 };
 
-void Example::App::SCBLInterpret(const std::string &p_code) {
-	m_scbll.Lex(p_code);
-	m_scblc.Compile(m_scbll.GetTokens());
-	m_scble.Run(m_scblc.GetStructcode());
+bool Example::App::IsTyped() const {
+	return m_typed;
 };
 
-void Example::App::Start(const u8 p_argc, const char *p_argv[]) {
+SCBL::Error Example::App::SCBLInterpret(const std::string &p_code) {
+	SCBL::Error error = m_scbll.TryLex(p_code);
+	if (error) {
+		m_scbll.Locate(error);
+
+		return error;
+	};
+
+	error = m_scblc.TryCompile(m_scbll);
+	if (error)
+		return error;
+
+	error = m_scble.TryRun(m_scblc.GetStructcode());
+	if (error and m_scblc.GetSourceMap().Locate(error))
+		m_scbll.Locate(error);
+
+	return error;
+};
+
+void Example::App::ReportError(const std::string &p_where, const SCBL::Error &p_error) {
+	Err() << "\n" << p_where;
+
+	if (p_error.IsCompilerError()) {
+		Err() << ":" << p_error.line << ":" << p_error.col;
+
+		m_exitCode = CompilerError;
+	} else if (p_error.IsRuntimeError()) {
+		// Runtime errors have a source position if the
+		// source map could locate them
+		if (p_error.line != 0)
+			Err() << ":" << p_error.line << ":" << p_error.col;
+		else
+			Err() << ":" << p_error.idx;
+
+		m_exitCode = RuntimeError;
+	} else
+		m_exitCode = GenericError;
+
+	Err()
+		<< ": error:\n  "
+		<< p_error.Message()
+		<< std::endl;
+};
+
+void Example::App::WriteTrace() {
+	if (m_traceFile.empty() or m_scble.DumpTrace(m_traceFile))
+		return;
+
+	Err()
+		<< "\nerror:\n  Could not write the trace into '"
+		<< m_traceFile
+		<< "'"
+		<< std::endl;
+
+	m_exitCode = GenericError;
+};
+
+void Example::App::PrintMemStats(const std::string &p_where) {
+	const SCBL::Lexer::MemStats       lexer    = m_scbll.GetMemStats();
+	const SCBL::Compiler::MemStats    compiler = m_scblc.GetMemStats();
+	const SCBL::Environment::MemStats env      = m_scble.GetMemStats();
+
+	std::ostream &err = Err();
+	const auto print = [&err](const char *p_name, const SCBL::MemUsage &p_usage) {
+		err
+			<< "  " << std::left << std::setw(12) << p_name
+			<< std::right << std::setw(10) << p_usage.count
+			<< std::setw(12) << p_usage.bytes << " bytes\n";
+	};
+
+	err << "\n" << p_where << ": memory:\n";
+	print("tokens",     lexer.tokens);
+	print("line index", lexer.lineIndex);
+	print("structcode", compiler.structcode);
+	print("source map", compiler.sourceMap);
+	print("functions",  env.funcs);
+	print("constants",  env.consts);
+	print("symbols",    env.symbols);
+	print("parameters", env.params);
+	print("param cache", env.paramCache);
+	print("eval cache", env.evalCache);
+
+	err
+		<< "  peak parameters " << env.peakParams << " bytes\n"
+		<< "  last run peak parameters " << env.runPeakParams
+		<< " bytes, constants " << env.runPeakConsts << " bytes"
+		<< std::endl;
+};
+
+void Example::App::Start(const int p_argc, const char *p_argv[]) {
 	std::vector<std::string> files = {};
 
 	bool startRepl = true;
 
 	startRepl = ReadParameters(p_argc, p_argv, files);
+	m_scblc.SetTyped(m_typed);
 
-	if (files.empty() and startRepl) {
-		Repl();
+	// The trace is dumped by the environment on runtime errors
+	// and once more when done
+	if (not m_traceFile.empty())
+		m_scble.EnableTrace(TraceCapacity, m_traceFile);
 
-		return;
-	};
+	if (m_watch and startRepl)
+		InterpretWatch(files);
+	else if (m_stream and startRepl) {
+		InterpretFiles(files);
+
+		if (m_exitCode == 0)
+			InterpretStream();
+	} else if (files.empty() and startRepl)
+		Repl();
+	else
+		InterpretFiles(files);
 
-	InterpretFiles(files);
+	WriteTrace();
 };
 
 bool Example::App::ReadParameters(
-	const u8 p_argc,
+	const int p_argc,
 	const char* p_argv[],
 	std::vector<std::string> &p_files
 ) {
 	bool startRepl = true;
 
-	for (u8 i = 1; i < p_argc; ++ i) {
+	for (int i = 1; i < p_argc; ++ i) {
 		std::string arg = p_argv[i];
 
 		switch (arg[0]) {
@@ -57,7 +174,20 @@ bool Example::App::ReadParameters(
 						<< "Usage: app [Options]"
 						<< "Options:\n"
 						<< "    -h, --help      Show the usage\n"
-						<< "    -v  --version   Show the current version"
+						<< "    -v  --version   Show the current version\n"
+						<< "        --mem-stats Print the memory statistics after interpreting\n"
+						<< "        --typed     Compile typed code, strings are passed with their\n"
+						<< "                    length and the functions read the argument table\n"
+						<< "        --trace FILE\n"
+						<< "                    Record the function calls, dumped into FILE at the\n"
+						<< "                    end or on a runtime error (see tools/tracedump.cc),\n"
+						<< "                    with --jobs the calls of file N go into FILE.N\n"
+						<< "        --stream    Interpret stdin after the files, compiling the next\n"
+						<< "                    part of the input while the previous one runs\n"
+						<< "    -j, --jobs N    Interpret N files at once (0 for all the cores), each\n"
+						<< "                    file gets its own environment\n"
+						<< "    -w, --watch     Interpret the files, then again every time they change,\n"
+						<< "                    only compiling the changed parts again"
 						<< std::endl;
 
 					startRepl = false;
@@ -72,6 +202,33 @@ bool Example::App::ReadParameters(
 						<< std::endl;
 
 					startRepl = false;
+				} else if (arg == "--mem-stats")
+					m_memStats = true;
+				else if (arg == "--typed")
+					m_typed = true;
+				else if (arg == "--stream")
+					m_stream = true;
+				else if (arg == "-w" or arg == "--watch")
+					m_watch = true;
+				else if (arg == "-j" or arg == "--jobs") {
+					if (i + 1 >= p_argc) {
+						std::cerr << "\nerror:\n  Missing the amount of jobs after '" << arg << "'" << std::endl;
+
+						m_exitCode = GenericError;
+						startRepl  = false;
+					} else {
+						m_jobs = std::strtoull(p_argv[++ i], nullptr, 10);
+						if (m_jobs == 0)
+							m_jobs = std::thread::hardware_concurrency();
+					};
+				} else if (arg == "--trace") {
+					if (i + 1 >= p_argc) {
+						std::cerr << "\nerror:\n  Missing file name after '--trace'" << std::endl;
+
+						m_exitCode = GenericError;
+						startRepl  = false;
+					} else
+						m_traceFile = p_argv[++ i];
 				};
 			};
 
@@ -123,34 +280,13 @@ void Example::App::Repl() {
 			std::cout << "Exited." << std::endl;
 
 			continue;
-		} else { // Else interpret
-			try {
-				SCBLInterpret(input);
-			} catch (const SCBL::CompilerException &error) {
-				std::cerr
-					<< "\nREPL:" << error.Line()
-					<< ":" << error.Col()
-					<< ": error:\n  "
-					<< error.What()
-					<< std::endl;
-
-				m_exitCode = CompilerError;
-			} catch (const SCBL::RuntimeException &error) {
-				std::cerr
-					<< "\nREPL:" << error.Idx()
-					<< ": error:\n  "
-					<< error.What()
-					<< std::endl;
-
-				m_exitCode = RuntimeError;
-			} catch (const SCBL::Exception &error) {
-				std::cerr
-					<< "\nREPL: error:\n  "
-					<< error.What()
-					<< std::endl;
-
-				m_exitCode = GenericError;
-			};
+		} else { // Else interpret, repeated commands are not compiled again
+			const SCBL::Error error = m_scble.TryEval(input);
+			if (error)
+				ReportError("REPL", error);
+
+			if (m_memStats)
+				PrintMemStats("REPL");
 		};
 
 		if (input.find('.') != std::string::npos)
@@ -159,11 +295,17 @@ void Example::App::Repl() {
 };
 
 void Example::App::InterpretFiles(const std::vector <std::string> &p_files) {
+	if (m_jobs > 1 and p_files.size() > 1) {
+		InterpretFilesParallel(p_files);
+
+		return;
+	};
+
 	// Execute all files if multiple were specified in
 	// the command line parameters
 	for (const std::string& file : p_files) {
 		if (not FileExists(file)) {
-			std::cerr
+			Err()
 				<< "\nerror:\n  File '"
 				<< file
 				<< "' not found"
@@ -173,53 +315,86 @@ void Example::App::InterpretFiles(const std::vector <std::string> &p_files) {
 			return;
 		};
 
-		try {
-			SCBLInterpret(ReadFile(file));
-		} catch (const SCBL::CompilerException &error) {
-			std::cerr
-				<< "\n" << file
-				<< ":" << error.Line()
-				<< ":" << error.Col()
-				<< ": error:\n  "
-				<< error.What()
-				<< std::endl;
+		std::string code;
+		if (not ReadFile(file, code)) {
+			ReportError(file, SCBL::Error(
+				SCBL::ErrorCode::Generic,
+				SCBL::ErrorSubject::Text,
+				"Could not open the file '" + file + "'"
+			));
 
-			m_exitCode = CompilerError;
-		} catch (const SCBL::RuntimeException &error) {
-			std::cerr
-				<< "\n" << file
-				<< ":" << error.Idx()
-				<< ": error:\n  "
-				<< error.What()
-				<< std::endl;
+			continue;
+		};
 
-			m_exitCode = RuntimeError;
-		} catch (const SCBL::Exception &error) {
-			std::cerr
-				<< "\n" << file
-				<< ": error:\n  "
-				<< error.What()
-				<< std::endl;
+		const SCBL::Error error = SCBLInterpret(code);
+		if (error)
+			ReportError(file, error);
 
-			m_exitCode = GenericError;
-		};
+		if (m_memStats)
+			PrintMemStats(file);
 	};
 };
 
 // private
+Example::App::App(
+	const App &p_parent,
+	std::ostream &p_out,
+	std::ostream &p_err,
+	const std::string &p_traceFile
+):
+	m_result(0),
+	m_exitCode(0),
+	m_memStats(p_parent.m_memStats),
+	m_typed(p_parent.m_typed),
+	m_traceFile(p_traceFile),
+	m_stream(false),
+	m_watch(false),
+	m_jobs(1),
+	m_out(&p_out),
+	m_err(&p_err)
+{
+	m_scble.SetUserData(static_cast<void*>(this));
+	m_scble.SetFuncs(p_parent.m_scble.GetFuncs());
+	m_scble.TryAddRegister("result", m_result);
+	m_scblc.SetTyped(m_typed);
+
+	if (not m_traceFile.empty())
+		m_scble.EnableTrace(TraceCapacity, m_traceFile);
+
+	m_sink = std::make_unique<SCBL::StreamSink>(p_out);
+	m_scble.GetOutput().SetSink(m_sink.get());
+};
+
+std::ostream &Example::App::Out() {
+	return *m_out;
+};
+
+std::ostream &Example::App::Err() {
+	return *m_err;
+};
+
 SCBL::Environment &Example::App::GetSCBLe() {
 	return m_scble;
 };
 
 void Example::App::Init() {
+#ifdef SCBL_HAS_WRITEV
+	m_sink = std::make_unique<SCBL::FdSink>(STDOUT_FILENO);
+#else // not SCBL_HAS_WRITEV
+	m_sink = std::make_unique<SCBL::StreamSink>(std::cout);
+#endif // SCBL_HAS_WRITEV
+
+	m_scble.GetOutput().SetSink(m_sink.get());
 	m_scble.SetUserData(static_cast<void*>(this));
-	m_scble.SetFunc("print", SCBL::Func(SCBLf_print));
-	m_scble.SetFunc("puts",  SCBL::Func(SCBLf_puts));
-	m_scble.SetFunc("set",   SCBL::Func(SCBLf_set));
-	m_scble.SetFunc("add",   SCBL::Func(SCBLf_add));
-	m_scble.SetFunc("sub",   SCBL::Func(SCBLf_sub));
-	m_scble.SetFunc("to64b", SCBL::Func(SCBLf_to64b));
-	m_scble.SetFunc("tostr", SCBL::Func(SCBLf_tostr));
+	m_scble.TrySetFunc("print", SCBL::Func(SCBLf_print));
+	m_scble.TrySetFunc("puts",  SCBL::Func(SCBLf_puts));
+	m_scble.TrySetFunc("set",   SCBL::Func(SCBLf_set));
+	m_scble.TrySetFunc("load",  SCBL::Func(SCBLf_load));
+	m_scble.TrySetFunc("add",   SCBL::Func(SCBLf_add));
+	m_scble.TrySetFunc("sub",   SCBL::Func(SCBLf_sub));
+	m_scble.TrySetFunc("to64b", SCBL::Func(SCBLf_to64b));
+	m_scble.TrySetFunc("tostr", SCBL::Func(SCBLf_tostr));
+	m_scble.TryAddRegister("result", m_result);
 };
 
 bool Example::App::FileExists(const std::string &p_name) const {
@@ -228,22 +403,23 @@ bool Example::App::FileExists(const std::string &p_name) const {
 	return fileHandle.good();
 };
 
-std::string Example::App::ReadFile(const std::string& p_fileName) {
-	std::string fileContents = "";
-	std::ifstream fileHandle(p_fileName);
+bool Example::App::ReadFile(const std::string& p_fileName, std::string &p_contents) {
+	std::ifstream fileHandle(p_fileName, std::ios::binary);
 
 	if (fileHandle.is_open()) {
-		std::string fileLine = "";
+		// Read at once, every line still ends with a new line
+		p_contents.assign(
+			std::istreambuf_iterator<char>(fileHandle),
+			std::istreambuf_iterator<char>()
+		);
 
-		while (std::getline(fileHandle, fileLine))
-			fileContents += fileLine + '\n';
+		if (not p_contents.empty() and p_contents.back() != '\n')
+			p_contents += '\n';
 
 		fileHandle.close();
 
-		return fileContents;
+		return true;
 	};
 
-	m_exitCode = GenericError;
-
-	throw SCBL::Exception("Could not open the file '" + p_fileName + "'");
+	return false;
 };
@@ -6,18 +6,22 @@
 #include "components.hh"
 #include "types.hh"
 #include "utils.hh"
+#include "queue.hh"
+#include "scanner.hh"
+#include "program.hh"
 
 namespace Example {
 	class App {
 	public:
 		// SCBL Functions
-		static void SCBLf_print(const std::vector<u8> p_params, void *_);
-		static void SCBLf_puts (const std::vector<u8> p_params, void *_);
-		static void SCBLf_set  (const std::vector<u8> p_params, void *p_app);
-		static void SCBLf_add  (const std::vector<u8> p_params, void *p_app);
-		static void SCBLf_sub  (const std::vector<u8> p_params, void *p_app);
-		static void SCBLf_to64b(const std::vector<u8> p_params, void *p_app);
-		static void SCBLf_tostr(const std::vector<u8> p_params, void *p_app);
+		static void SCBLf_print(const SCBL::ParamSegments p_params, void *p_app);
+		static void SCBLf_puts (const SCBL::ParamSegments p_params, void *p_app);
+		static void SCBLf_set  (const SCBL::ParamView p_params, void *p_app);
+		static void SCBLf_load (const SCBL::ParamView p_params, void *p_app);
+		static void SCBLf_add  (const SCBL::ParamView p_params, void *p_app);
+		static void SCBLf_sub  (const SCBL::ParamView p_params, void *p_app);
+		static void SCBLf_to64b(const SCBL::ParamView p_params, void *p_app);
+		static void SCBLf_tostr(const SCBL::ParamView p_params, void *p_app);
 
 		// Exitcode error IDs
 		static const constexpr u8 CompilerError = 1;
@@ -25,37 +29,105 @@ namespace Example {
 		static const constexpr u8 GenericError  = 3;
 		static const constexpr u8 FileNotFound  = 4;
 
+		static const constexpr usize TraceCapacity = 4096; // Calls kept by --trace
+
+		// --stream reads the input in blocks of this size and keeps
+		// at most this many compiled batches waiting to run
+		static const constexpr usize StreamBlockSize     = 64 * 1024;
+		static const constexpr usize StreamQueueCapacity = 16;
+
 		App();
-		App(const u8 p_argc, const char *p_argv[]);
+		App(const int p_argc, const char *p_argv[]);
 
 		~App();
 
 		u8 GetExitcode() const;
+		bool IsTyped() const;
 
-		void Start(const u8 p_argc, const char *p_argv[]);
+		void Start(const int p_argc, const char *p_argv[]);
 		void Repl(); // Read Eval Print Loop
 		void InterpretFiles(const std::vector<std::string> &p_files);
+		void InterpretFilesParallel(const std::vector<std::string> &p_files); // See jobs.cc
+		void InterpretStream(); // Reads the code from stdin, see stream.cc
+		void InterpretWatch(const std::vector<std::string> &p_files); // See watch.cc
 
 	private:
+		// Clone for --jobs, with the functions of p_parent and its
+		// output going into the given streams. The calls are traced
+		// into p_traceFile if it is not empty
+		App(
+			const App &p_parent,
+			std::ostream &p_out,
+			std::ostream &p_err,
+			const std::string &p_traceFile
+		);
+
+		std::ostream &Out();
+		std::ostream &Err();
+
+		// A part of the streamed input, compiled by the producer thread
+		struct Batch {
+		public:
+			std::string code;
+			usize line; // Line of the input the code starts at
+
+			SCBL::Compiler scblc;
+			SCBL::Error error; // Compiler error, reported when the batch is reached
+
+			bool last;
+		}; // struct Batch
+
+		using BatchQueue = Utils::SpscQueue<std::unique_ptr<Batch>>;
+
+		static void StreamProduce(
+			BatchQueue &p_queue,
+			const std::atomic<bool> &p_stop,
+			const FuncNames &p_funcs,
+			const bool p_typed
+		);
+
 		SCBL::Environment &GetSCBLe();
 		void Init();
 
 		bool FileExists(const std::string &p_name) const;
-		std::string ReadFile(const std::string& p_fileName);
+		bool ReadFile(const std::string& p_fileName, std::string &p_contents);
 
 		bool ReadParameters(
-			const u8 p_argc,
+			const int p_argc,
 			const char* p_argv[],
 			std::vector<std::string> &p_files
 		);
 
-		void SCBLInterpret(const std::string &p_code);
+		SCBL::Error SCBLInterpret(const std::string &p_code);
+		void ReportError(const std::string &p_where, const SCBL::Error &p_error);
+		void WriteTrace(); // Into the --trace file, if there is one
+		void PrintMemStats(const std::string &p_where);
+
+		// Sets a constant, reporting the error instead of throwing
+		static void SetResult(
+			App &p_app,
+			const std::string &p_name,
+			const SCBL::Const &p_const
+		);
 
 		SCBL::Lexer m_scbll;
 		SCBL::Compiler m_scblc;
 		SCBL::Environment m_scble;
+		usize m_result; // Register of the result of the arithmetic functions
 
 		usize m_exitCode;
+		bool m_memStats; // Print the memory statistics after interpreting
+		bool m_typed; // Compile typed code with --typed
+		std::string m_traceFile; // Trace the function calls into this file
+		bool m_stream; // Interpret stdin with --stream
+		bool m_watch; // Interpret the files again when they change with --watch
+		usize m_jobs; // Files interpreted at once with --jobs
+
+		std::ostream *m_out, *m_err;
+
+		// Where print and puts write, the output of the
+		// environment is flushed into it after every run
+		std::unique_ptr<SCBL::OutputSink> m_sink;
 	}; // class App
 }; // namespace Example
 
@@ -3,9 +3,20 @@
 
 #include <iostream> // std::cout, std::cerr, std::cin
 #include <fstream> // std::ofstream, std::ifstream
+#include <iomanip> // std::setw, std::left, std::right
 #include <string> // std::string, std::getline
 #include <cstdlib> // free
+#include <cstring> // std::memchr
 #include <unordered_map> // std::unordered_map
+#include <unordered_set> // std::unordered_set
+#include <memory> // std::unique_ptr, std::make_unique
+#include <algorithm> // std::count
+#include <atomic> // std::atomic
+#include <thread> // std::thread
+#include <sstream> // std::ostringstream
+#include <mutex> // std::mutex, std::lock_guard, std::unique_lock
+#include <condition_variable> // std::condition_variable
+#include <iterator> // std::istreambuf_iterator
 #include <scbl.hh> // SCBL::Interpreter, SCBL::Exception, SCBL::word,
                    // SCBL::i8, SCBL::i16, SCBL::i32, SCBL::i64,
                    // SCBL::ui8, SCBL::ui16, SCBL::ui32, SCBL::ui64
@@ -2,7 +2,10 @@
 #define __CONFIG_HH_HEADER_GUARD__
 
 //#define SCBL_DONT_USE_EXCEPTIONS // Use exit codes instead
-                                   // of exceptions in SCBL
+                                   // of exceptions in SCBL,
+                                   // the example only uses the
+                                   // Try* functions so it works
+                                   // either way
 #define UTILS_USE_GNU_READLINE // If the platform is Linux,
                                // use GNU readline/readline.h
 
@@ -0,0 +1,87 @@
+#include "app.hh"
+
+/*
+ *  --jobs mode
+ *
+ *  Every file is interpreted by its own App cloned from this one, on a
+ *  pool of threads, so the next files are compiled while the current
+ *  ones run. The output and errors of each file are buffered and
+ *  written in the order of the files, as soon as the files before
+ *  them are done. With --trace FILE, the calls of the Nth file are
+ *  traced into FILE.N.
+ */
+
+namespace {
+	struct Job {
+	public:
+		std::ostringstream out, err;
+
+		u8   exitCode = 0;
+		bool done     = false;
+	}; // struct Job
+};
+
+// public
+void Example::App::InterpretFilesParallel(const std::vector<std::string> &p_files) {
+	// Like InterpretFiles, nothing after a missing file is interpreted
+	usize count = 0;
+	while (count < p_files.size() and FileExists(p_files[count]))
+		++ count;
+
+	std::vector<Job> jobs(count);
+	std::mutex mutex;
+	std::condition_variable jobDone;
+
+	std::thread runner([&]() {
+		SCBL::Tools::ParallelFor(m_jobs, count, [&](const usize p_idx) {
+			Job &job = jobs[p_idx];
+
+			// Every file is traced into its own file, counted from 1
+			std::string traceFile;
+			if (not m_traceFile.empty())
+				traceFile = m_traceFile + "." + std::to_string(p_idx + 1);
+
+			App app(*this, job.out, job.err, traceFile);
+			app.InterpretFiles({p_files[p_idx]});
+			app.WriteTrace();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			job.exitCode = app.GetExitcode();
+			job.done     = true;
+
+			jobDone.notify_one();
+		});
+	});
+
+	for (Job &job : jobs) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobDone.wait(lock, [&job]() {
+				return job.done;
+			});
+		};
+
+		Out() << job.out.str() << std::flush;
+		Err() << job.err.str() << std::flush;
+
+		// The last error decides the exit code, like when
+		// interpreting the files one by one
+		if (job.exitCode != 0)
+			m_exitCode = job.exitCode;
+
+		job.out.str(std::string());
+		job.err.str(std::string());
+	};
+
+	runner.join();
+
+	if (count < p_files.size()) {
+		Err()
+			<< "\nerror:\n  File '"
+			<< p_files[count]
+			<< "' not found"
+			<< std::endl;
+
+		m_exitCode = FileNotFound;
+	};
+};
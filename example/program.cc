@@ -0,0 +1,176 @@
+#include "program.hh"
+
+// public
+SCBL::Error Example::Program::Compile(
+	std::string p_code,
+	const FuncNames &p_funcs,
+	const bool p_typed,
+	std::shared_ptr<const Program> &p_program,
+	const Program *p_previous
+) {
+	std::shared_ptr<Program> program = std::make_shared<Program>();
+	program->m_code  = std::move(p_code);
+	program->m_typed = p_typed;
+
+	const std::string &code = program->m_code;
+	if (p_previous == nullptr or p_previous->m_entries.empty()) {
+		usize end = code.size();
+		const SCBL::Error error = program->CompileRange(0, end, p_funcs);
+		if (error)
+			return error;
+
+		p_program = program;
+
+		return SCBL::Error();
+	};
+
+	const std::string &old = p_previous->m_code;
+	const std::vector<Entry> &entries = p_previous->m_entries;
+
+	// Only the part between the common prefix and suffix changed
+	const usize common = std::min(old.size(), code.size());
+
+	usize prefix = 0;
+	while (prefix < common and old[prefix] == code[prefix])
+		++ prefix;
+
+	usize suffix = 0;
+	while (
+		suffix < common - prefix and
+		old[old.size() - suffix - 1] == code[code.size() - suffix - 1]
+	)
+		++ suffix;
+
+	// The chunk before the change is compiled again too, the changed
+	// line could continue its last call. So is the chunk with the
+	// first unchanged byte, its line could now continue the change
+	const usize changeBegin = prefix > 0? prefix - 1 : 0;
+	const usize changeEnd   = old.size() - suffix;
+
+	usize first = 0;
+	while (first + 1 < entries.size() and entries[first].end <= changeBegin)
+		++ first;
+
+	usize last = first;
+	while (last + 1 < entries.size() and entries[last].end <= changeEnd)
+		++ last;
+
+	const usize begin = entries[first].begin;
+	usize end = entries[last].end + code.size() - old.size();
+
+	program->m_entries.assign(entries.begin(), entries.begin() + first);
+
+	const SCBL::Error error = program->CompileRange(begin, end, p_funcs);
+	if (error)
+		return error;
+
+	// The compiled range only grows if it ends in a multi-line comment,
+	// then it ends at the end of the code
+	if (end != code.size()) {
+		for (usize i = last + 1; i < entries.size(); ++ i) {
+			Entry entry = entries[i];
+			entry.begin += code.size() - old.size();
+			entry.end   += code.size() - old.size();
+
+			program->m_entries.push_back(entry);
+		};
+	};
+
+	p_program = program;
+
+	return SCBL::Error();
+};
+
+SCBL::Error Example::Program::Run(SCBL::Environment &p_scble) const {
+	for (const Entry &entry : m_entries) {
+		SCBL::Error error = p_scble.TryRun(entry.chunk->scblc.GetStructcode());
+		if (not error)
+			continue;
+
+		// The source map has the offsets from when the chunk was compiled
+		if (entry.chunk->scblc.GetSourceMap().Locate(error)) {
+			error.offset = error.offset - entry.chunk->begin + entry.begin;
+
+			SCBL::LineIndex(m_code).Locate(error);
+		};
+
+		return error;
+	};
+
+	return SCBL::Error();
+};
+
+const std::string &Example::Program::GetCode() const {
+	return m_code;
+};
+
+usize Example::Program::GetCompiledBytes() const {
+	return m_compiledBytes;
+};
+
+usize Example::Program::GetChunkCount() const {
+	return m_entries.size();
+};
+
+// private
+SCBL::Error Example::Program::CompileRange(
+	const usize p_begin,
+	usize &p_end,
+	const FuncNames &p_funcs
+) {
+	Scanner scanner;
+	scanner.scanned = p_begin;
+	scanner.Scan(m_code, p_end);
+
+	// Chunks can not start inside of a multi-line comment
+	switch (scanner.state) {
+	case ScanState::CommMul:
+	case ScanState::CommMulStar:
+		p_end = m_code.size();
+		scanner.Scan(m_code);
+
+		break;
+
+	default: break;
+	};
+
+	std::vector<usize> cuts;
+	usize chunkBegin = p_begin;
+	for (const usize lineStart : scanner.lineStarts) {
+		if (
+			lineStart < p_end and
+			lineStart - chunkBegin >= ChunkSize and
+			Scanner::StartsWithFunc(m_code, lineStart, p_funcs)
+		) {
+			cuts.push_back(lineStart);
+			chunkBegin = lineStart;
+		};
+	};
+
+	cuts.push_back(p_end);
+
+	SCBL::Lexer scbll;
+
+	chunkBegin = p_begin;
+	for (const usize cut : cuts) {
+		std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+		chunk->begin = chunkBegin;
+		chunk->scblc.SetTyped(m_typed);
+
+		SCBL::Error error = scbll.TryLex(m_code, chunkBegin, cut);
+		if (error)
+			scbll.Locate(error);
+		else
+			error = chunk->scblc.TryCompile(scbll);
+
+		if (error)
+			return error;
+
+		m_entries.push_back({chunk, chunkBegin, cut});
+		m_compiledBytes += cut - chunkBegin;
+
+		chunkBegin = cut;
+	};
+
+	return SCBL::Error();
+};
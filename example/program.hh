@@ -0,0 +1,66 @@
+#ifndef __PROGRAM_HH_HEADER_GUARD__
+#define __PROGRAM_HH_HEADER_GUARD__
+
+#include "components.hh"
+#include "types.hh"
+#include "scanner.hh"
+
+namespace Example {
+	// Script compiled in chunks, each starting at a line which begins
+	// with a function name so no call is split between two of them.
+	// Compiling a changed version of the script only compiles the
+	// chunks around the change again, the others are shared with the
+	// previous version
+	class Program {
+	public:
+		// Chunks are cut at the first possible line after this many bytes
+		static const constexpr usize ChunkSize = 4 * 1024;
+
+		// Compiles p_code into p_program, reusing the chunks of p_previous
+		// where the code did not change. Compiler errors have their line
+		// and column. p_typed compiles typed code (see --typed)
+		static SCBL::Error Compile(
+			std::string p_code,
+			const FuncNames &p_funcs,
+			const bool p_typed,
+			std::shared_ptr<const Program> &p_program,
+			const Program *p_previous = nullptr
+		);
+
+		// Runs the chunks in order, runtime errors get the line and
+		// column they happened at
+		SCBL::Error Run(SCBL::Environment &p_scble) const;
+
+		const std::string &GetCode() const;
+
+		usize GetCompiledBytes() const; // Bytes compiled for this version
+		usize GetChunkCount() const;
+
+	private:
+		struct Chunk {
+		public:
+			usize begin; // Where the chunk was when it was compiled
+
+			SCBL::Compiler scblc;
+		}; // struct Chunk
+
+		struct Entry {
+		public:
+			std::shared_ptr<const Chunk> chunk;
+			usize begin, end; // Where the chunk is in this version
+		}; // struct Entry
+
+		// Splits the code between the offsets into chunks and compiles
+		// them. p_end is moved to the end of the code if the range ends
+		// in a multi-line comment
+		SCBL::Error CompileRange(const usize p_begin, usize &p_end, const FuncNames &p_funcs);
+
+		std::string m_code;
+		std::vector<Entry> m_entries;
+
+		usize m_compiledBytes = 0;
+		bool  m_typed = false;
+	}; // class Program
+}; // namespace Example
+
+#endif // __PROGRAM_HH_HEADER_GUARD__
@@ -0,0 +1,95 @@
+#ifndef __QUEUE_HH_HEADER_GUARD__
+#define __QUEUE_HH_HEADER_GUARD__
+
+#include <vector> // std::vector
+#include <atomic> // std::atomic
+#include <thread> // std::this_thread::yield, std::this_thread::sleep_for
+#include <chrono> // std::chrono::microseconds
+#include <utility> // std::move
+
+#include "types.hh"
+
+namespace Utils {
+	// Bounded lock-free queue for one producer thread and one consumer
+	// thread. Push waits while the queue is full, so a fast producer
+	// can not run ahead of the consumer
+	template <typename T>
+	class SpscQueue {
+	public:
+		// The capacity is rounded up to a power of 2
+		SpscQueue(const usize p_capacity):
+			m_head(0),
+			m_tail(0)
+		{
+			usize capacity = 1;
+			while (capacity < p_capacity)
+				capacity <<= 1;
+
+			m_slots.resize(capacity);
+			m_mask = capacity - 1;
+		};
+
+		// Called by the producer, p_value is only moved from on success
+		bool TryPush(T &p_value) {
+			const usize tail = m_tail.load(std::memory_order_relaxed);
+			if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+				return false;
+
+			m_slots[tail & m_mask] = std::move(p_value);
+			m_tail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		};
+
+		// Called by the consumer
+		bool TryPop(T &p_value) {
+			const usize head = m_head.load(std::memory_order_relaxed);
+			if (head == m_tail.load(std::memory_order_acquire))
+				return false;
+
+			p_value = std::move(m_slots[head & m_mask]);
+			m_head.store(head + 1, std::memory_order_release);
+
+			return true;
+		};
+
+		// Waits until there is space or p_stop is set, returns false if stopped
+		bool Push(T &p_value, const std::atomic<bool> &p_stop) {
+			usize spins = 0;
+			while (not TryPush(p_value)) {
+				if (p_stop.load(std::memory_order_relaxed))
+					return false;
+
+				Wait(spins);
+			};
+
+			return true;
+		};
+
+		void Pop(T &p_value) {
+			usize spins = 0;
+			while (not TryPop(p_value))
+				Wait(spins);
+		};
+
+	private:
+		// Yields for a while, then sleeps so a long wait (like for
+		// input from a pipe) does not keep a core busy
+		static void Wait(usize &p_spins) {
+			if (p_spins < 64) {
+				++ p_spins;
+				std::this_thread::yield();
+			} else
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+		};
+
+		std::vector<T> m_slots;
+		usize m_mask;
+
+		// On separate cache lines so the threads do not fight over them
+		alignas(64) std::atomic<usize> m_head; // Written by the consumer
+		alignas(64) std::atomic<usize> m_tail; // Written by the producer
+	}; // class SpscQueue
+}; // namespace Utils
+
+#endif // __QUEUE_HH_HEADER_GUARD__
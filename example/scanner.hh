@@ -0,0 +1,163 @@
+#ifndef __SCANNER_HH_HEADER_GUARD__
+#define __SCANNER_HH_HEADER_GUARD__
+
+#include "components.hh"
+#include "types.hh"
+
+namespace Example {
+	using FuncNames = std::unordered_set<std::string>;
+
+	// Where the scanner is in the code, to know which new lines start
+	// a line of code and not continue a multi-line comment
+	enum class ScanState : u8 {
+		Code,
+		Slash,
+		Str,
+		StrEscape,
+		Comm,
+		CommMul,
+		CommMulStar
+	}; // enum class ScanState
+
+	struct Scanner {
+	public:
+		// Records the line starts in p_code from where it stopped last time
+		void Scan(const std::string &p_code) {
+			Scan(p_code, p_code.size());
+		};
+
+		// Same as Scan, but stops at p_end
+		void Scan(const std::string &p_code, const usize p_end) {
+			for (; scanned < p_end; ++ scanned) {
+				const char ch = p_code[scanned];
+
+				switch (state) {
+				case ScanState::Code:
+					switch (ch) {
+					case '"': state = ScanState::Str;   break;
+					case '#': state = ScanState::Comm;  break;
+					case '/': state = ScanState::Slash; break;
+					};
+
+					break;
+
+				case ScanState::Slash:
+					switch (ch) {
+					case '*': state = ScanState::CommMul; break;
+					case '/': state = ScanState::Comm;    break;
+
+					default: state = ScanState::Code; break;
+					};
+
+					break;
+
+				// Strings and their escapes end at a new line too,
+				// the lexer reports it
+				case ScanState::Str:
+					switch (ch) {
+					case '\\': state = ScanState::StrEscape; break;
+					case '"':  state = ScanState::Code;      break;
+					};
+
+					break;
+
+				case ScanState::StrEscape: state = ScanState::Str; break;
+
+				case ScanState::CommMul:
+					if (ch == '*')
+						state = ScanState::CommMulStar;
+
+					break;
+
+				case ScanState::CommMulStar:
+					switch (ch) {
+					case '/': state = ScanState::Code; break;
+					case '*': break;
+
+					default: state = ScanState::CommMul; break;
+					};
+
+					break;
+
+				default: break;
+				};
+
+				if (ch == '\n') {
+					switch (state) {
+					case ScanState::CommMul:
+					case ScanState::CommMulStar:
+						break;
+
+					default:
+						state = ScanState::Code;
+						lineStarts.push_back(scanned + 1);
+					};
+				};
+			};
+		};
+
+		// Last line start which begins with a complete function name,
+		// 0 if there is none
+		usize FindCut(const std::string &p_code, const FuncNames &p_funcs) const {
+			for (auto it = lineStarts.rbegin(); it != lineStarts.rend(); ++ it) {
+				if (StartsWithFunc(p_code, *it, p_funcs))
+					return *it;
+			};
+
+			return 0;
+		};
+
+		// If the line at p_lineStart begins with a complete function name
+		static bool StartsWithFunc(
+			const std::string &p_code,
+			usize p_lineStart,
+			const FuncNames &p_funcs
+		) {
+			while (p_lineStart < p_code.size()) {
+				switch (p_code[p_lineStart]) {
+				case ' ': case '\t': case '\r':
+					++ p_lineStart;
+					continue;
+				};
+
+				break;
+			};
+
+			usize end = p_lineStart;
+			for (; end < p_code.size(); ++ end) {
+				switch (p_code[end]) {
+				case SCBL_NAME_CHARS:
+				case SCBL_DEC_CHARS:
+					continue;
+				};
+
+				break;
+			};
+
+			// The name could continue in the next block
+			if (end == p_code.size() or end == p_lineStart)
+				return false;
+
+			return p_funcs.count(p_code.substr(p_lineStart, end - p_lineStart)) != 0;
+		};
+
+		// Forgets everything before p_cut
+		void Cut(const usize p_cut) {
+			usize kept = 0;
+			for (const usize lineStart : lineStarts) {
+				if (lineStart > p_cut)
+					lineStarts[kept ++] = lineStart - p_cut;
+			};
+
+			lineStarts.resize(kept);
+			scanned -= p_cut;
+		};
+
+		ScanState state = ScanState::Code;
+		usize scanned = 0;
+
+		std::vector<usize> lineStarts;
+	}; // struct Scanner
+}; // namespace Example
+
+#endif // __SCANNER_HH_HEADER_GUARD__
@@ -1,128 +1,211 @@
 #include "app.hh"
 
-void Example::App::SCBLf_print(const std::vector<u8> p_params, void *_) {
-	for (const char ch : p_params) {
-		switch (ch) {
-			case 0: break;
-			default: std::cout << ch;
-		};
+void Example::App::SetResult(
+	App &p_app,
+	const std::string &p_name,
+	const SCBL::Const &p_const
+) {
+	const SCBL::Error error = p_app.GetSCBLe().TrySetConst(p_name, p_const);
+	if (error)
+		p_app.Err()
+			<< "\nerror:\n  "
+			<< error.Message()
+			<< std::endl;
+};
+
+// Writes the parameters as text, without the null terminators
+static void WriteText(SCBL::Output &p_output, const SCBL::ParamView p_params) {
+	const char *it  = reinterpret_cast<const char*>(p_params.begin());
+	const char *end = reinterpret_cast<const char*>(p_params.end());
+	while (it < end) {
+		const char *null = static_cast<const char*>(std::memchr(it, 0, end - it));
+		if (null == nullptr)
+			null = end;
+
+		p_output.Write(it, null - it);
+		it = null + 1;
 	};
+};
 
-	std::cout << std::endl;
+// Typed code (--typed) passes strings with their length instead of a
+// null terminator. Joins the arguments from p_first on into p_bytes,
+// strings as their characters and the rest as they are
+static void JoinArgs(
+	const SCBL::Tools::ParamHandler &p_phandle,
+	const usize p_first,
+	std::vector<u8> &p_bytes
+) {
+	std::string str;
+	for (usize i = p_first; i < p_phandle.GetArgCount(); ++ i) {
+		SCBL::ParamView bytes;
+		if (p_phandle.TryGetArgStr(i, str))
+			p_bytes.insert(p_bytes.end(), str.begin(), str.end());
+		else if (p_phandle.TryGetArgView(i, bytes))
+			p_bytes.insert(p_bytes.end(), bytes.begin(), bytes.end());
+	};
 };
 
-void Example::App::SCBLf_puts(const std::vector<u8> p_params, void *_) {
-	for (const char ch : p_params) {
-		switch (ch) {
-			case 0: break;
-			default: std::cout << ch;
-		};
+// Constants are passed as their own segments, so printing big ones
+// does not copy them into the parameters first
+static void WriteParams(Example::App &p_app, SCBL::Output &p_output, const SCBL::ParamSegments p_params) {
+	if (not p_app.IsTyped()) {
+		for (const SCBL::ParamView segment : p_params)
+			WriteText(p_output, segment);
+
+		return;
 	};
+
+	// The argument table is at the end of all the segments together
+	std::vector<u8> params, text;
+	p_params.Gather(params);
+
+	SCBL::Tools::ParamHandler phandle(params);
+	if (phandle.TryReadArgs())
+		JoinArgs(phandle, 0, text);
+
+	WriteText(p_output, text);
+};
+
+void Example::App::SCBLf_print(const SCBL::ParamSegments p_params, void *p_app) {
+	Example::App &app = *static_cast<Example::App*>(p_app);
+	SCBL::Output &output = app.GetSCBLe().GetOutput();
+
+	WriteParams(app, output, p_params);
+	output.Put('\n');
+};
+
+void Example::App::SCBLf_puts(const SCBL::ParamSegments p_params, void *p_app) {
+	Example::App &app = *static_cast<Example::App*>(p_app);
+
+	WriteParams(app, app.GetSCBLe().GetOutput(), p_params);
 };
 
-void Example::App::SCBLf_set(const std::vector<u8> p_params, void *p_app) {
+void Example::App::SCBLf_set(const SCBL::ParamView p_params, void *p_app) {
 	Example::App &app = *static_cast<Example::App*>(p_app);
-	SCBL::Environment &scble = app.GetSCBLe();
 	SCBL::Tools::ParamHandler phandle(p_params);
+	if (app.IsTyped())
+		phandle.TryReadArgs();
 
 	std::string varName;
-	try {
-		varName = phandle.GetNextParamStr();
-	} catch (...) {
-		std::cerr
+	if (not phandle.TryGetNextParamStr(varName)) {
+		app.Err()
 			<< "\nset: Expected a variable name"
 			<< std::endl;
 
 		return;
 	};
 
-	std::vector<u8> bytes;
-	bool hasParams = true;
-	while (hasParams) {
-		try {
-			bytes.push_back(phandle.GetNextParam8());
-		} catch (...) {
-			hasParams = false;
-		};
+	// The rest of the parameters is the value
+	if (not app.IsTyped()) {
+		SetResult(app, varName, SCBL::Const(phandle.Rest()));
+
+		return;
+	};
+
+	std::vector<u8> value;
+	JoinArgs(phandle, 1, value);
+	SetResult(app, varName, SCBL::Const(value));
+};
+
+void Example::App::SCBLf_load(const SCBL::ParamView p_params, void *p_app) {
+	Example::App &app = *static_cast<Example::App*>(p_app);
+	SCBL::Tools::ParamHandler phandle(p_params);
+	if (app.IsTyped())
+		phandle.TryReadArgs();
+
+	std::string varName, path;
+	if (
+		not phandle.TryGetNextParamStr(varName) or
+		not phandle.TryGetNextParamStr(path)
+	) {
+		app.Err()
+			<< "\nload: Expected a variable name and a file path"
+			<< std::endl;
+
+		return;
+	};
+
+	// The file is mapped, not copied
+	SCBL::Const contents;
+	const SCBL::Error error = SCBL::Const::TryFromFile(path, contents);
+	if (error) {
+		app.Err()
+			<< "\nload: "
+			<< error.Message()
+			<< std::endl;
+
+		return;
 	};
 
-	scble.SetConst(varName, SCBL::Const(bytes));
+	SetResult(app, varName, contents);
 };
 
-void Example::App::SCBLf_tostr(const std::vector<u8> p_params, void *p_app) {
+void Example::App::SCBLf_tostr(const SCBL::ParamView p_params, void *p_app) {
 	Example::App &app = *static_cast<Example::App*>(p_app);
-	SCBL::Environment &scble = app.GetSCBLe();
 	SCBL::Tools::ParamHandler phandle(p_params);
 
 	u64 num;
-	try {
-		num = phandle.GetNextParamInt();
-	} catch (...) {
-		std::cerr
+	if (not phandle.TryGetNextParamInt(num)) {
+		app.Err()
 			<< "\ntostr: Expected a number"
 			<< std::endl;
 
 		return;
 	};
 
-	scble.SetConst("result", SCBL::Const(std::to_string(num)));
+	app.GetSCBLe().SetRegister(app.m_result, std::to_string(num));
 };
 
-void Example::App::SCBLf_to64b(const std::vector<u8> p_params, void *p_app) {
+void Example::App::SCBLf_to64b(const SCBL::ParamView p_params, void *p_app) {
 	Example::App &app = *static_cast<Example::App*>(p_app);
-	SCBL::Environment &scble = app.GetSCBLe();
 	SCBL::Tools::ParamHandler phandle(p_params);
 
 	u64 num;
-	try {
-		num = phandle.GetNextParamInt();
-	} catch (...) {
-		std::cerr
+	if (not phandle.TryGetNextParamInt(num)) {
+		app.Err()
 			<< "\nto64b: Expected a number"
 			<< std::endl;
 
 		return;
 	};
 
-	scble.SetConst("result", SCBL::Const(num, SCBL::Const::Size64b));
+	app.GetSCBLe().SetRegister(app.m_result, num);
 };
 
-void Example::App::SCBLf_add(const std::vector<u8> p_params, void *p_app) {
+void Example::App::SCBLf_add(const SCBL::ParamView p_params, void *p_app) {
 	Example::App &app = *static_cast<Example::App*>(p_app);
-	SCBL::Environment &scble = app.GetSCBLe();
 	SCBL::Tools::ParamHandler phandle(p_params);
 
 	u64 num1, num2;
-	try {
-		num1 = phandle.GetNextParam64();
-		num2 = phandle.GetNextParam64();
-	} catch (...) {
-		std::cerr
+	if (
+		not phandle.TryGetNextParam64(num1) or
+		not phandle.TryGetNextParam64(num2)
+	) {
+		app.Err()
 			<< "\nadd: Expected a 64bit number"
 			<< std::endl;
 
 		return;
 	};
 
-	scble.SetConst("result", SCBL::Const(num1 + num2, SCBL::Const::Size64b));
+	app.GetSCBLe().SetRegister(app.m_result, num1 + num2);
 };
 
-void Example::App::SCBLf_sub(const std::vector<u8> p_params, void *p_app) {
+void Example::App::SCBLf_sub(const SCBL::ParamView p_params, void *p_app) {
 	Example::App &app = *static_cast<Example::App*>(p_app);
-	SCBL::Environment &scble = app.GetSCBLe();
 	SCBL::Tools::ParamHandler phandle(p_params);
 
 	u64 num1, num2;
-	try {
-		num1 = phandle.GetNextParam64();
-		num2 = phandle.GetNextParam64();
-	} catch (...) {
-		std::cerr
+	if (
+		not phandle.TryGetNextParam64(num1) or
+		not phandle.TryGetNextParam64(num2)
+	) {
+		app.Err()
 			<< "\nsub: Expected a 64bit number"
 			<< std::endl;
 
 		return;
 	};
 
-	scble.SetConst("result", SCBL::Const(num1 - num2, SCBL::Const::Size64b));
+	app.GetSCBLe().SetRegister(app.m_result, num1 - num2);
 };
@@ -0,0 +1,157 @@
+#include "app.hh"
+
+/*
+ *  --stream mode
+ *
+ *  A producer thread reads stdin in blocks, cuts them into batches and
+ *  lexes and compiles them, while the main thread runs the previous
+ *  batches. Batches are only cut at the start of a line which begins
+ *  with a function name, so no call gets split in two.
+ */
+
+#if defined(PLATFORM_LINUX) or defined(PLATFORM_APPLE) or defined(PLATFORM_UNIX)
+#	define STREAM_USE_POLL
+#	include <poll.h> // poll, struct pollfd
+#	include <unistd.h> // read, STDIN_FILENO
+#	include <cerrno> // errno, EINTR
+#endif
+
+namespace {
+	// How often the producer checks if it should stop while it waits
+	// for the input
+	const constexpr int StopCheckMs = 50;
+
+	// Reads stdin until p_data is full or the input ends, returns the
+	// amount of bytes read. With poll the wait is given up when p_stop
+	// is set, so the main thread never waits on the input to join the
+	// producer, and what was read is returned when the input pauses.
+	// Elsewhere the read blocks until the block is full
+	usize ReadBlock(std::vector<char> &p_data, const std::atomic<bool> &p_stop, bool &p_eof) {
+#ifdef STREAM_USE_POLL
+		pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+
+		usize size = 0;
+		while (size < p_data.size() and not p_stop) {
+			const int ready = poll(&pfd, 1, StopCheckMs);
+			if (ready == 0 and size > 0)
+				break;
+
+			if (ready == 0 or (ready < 0 and errno == EINTR))
+				continue;
+
+			const ssize_t got = ready < 0? -1 : read(STDIN_FILENO, p_data.data() + size, p_data.size() - size);
+			if (got < 0 and errno == EINTR)
+				continue;
+
+			// Errors end the input like the end of the file
+			if (got <= 0) {
+				p_eof = true;
+
+				break;
+			};
+
+			size += got;
+		};
+
+		return size;
+#else // not STREAM_USE_POLL
+		std::cin.read(p_data.data(), p_data.size());
+		p_eof = not std::cin;
+
+		return std::cin.gcount();
+#endif // STREAM_USE_POLL
+	};
+};
+
+// public
+void Example::App::InterpretStream() {
+	BatchQueue queue(StreamQueueCapacity);
+	std::atomic<bool> stop(false);
+
+	// The producer only needs the function names, so it does not
+	// touch the environment while it runs
+	FuncNames funcs;
+	for (const auto &name : m_scble.GetFuncNames())
+		funcs.insert(std::string(name));
+
+	std::thread producer(StreamProduce, std::ref(queue), std::cref(stop), std::cref(funcs), m_typed);
+
+	std::unique_ptr<Batch> batch;
+	do {
+		queue.Pop(batch);
+
+		SCBL::Error error = batch->error;
+		if (not error) {
+			error = m_scble.TryRun(batch->scblc.GetStructcode());
+			if (error and batch->scblc.GetSourceMap().Locate(error))
+				SCBL::LineIndex(batch->code).Locate(error);
+		};
+
+		if (error) {
+			// Batches start at the start of a line
+			if (error.line != 0)
+				error.line += batch->line - 1;
+
+			ReportError("stdin", error);
+			stop = true;
+
+			break;
+		};
+	} while (not batch->last);
+
+	producer.join();
+
+	if (m_memStats)
+		PrintMemStats("stdin");
+};
+
+// private
+void Example::App::StreamProduce(
+	BatchQueue &p_queue,
+	const std::atomic<bool> &p_stop,
+	const FuncNames &p_funcs,
+	const bool p_typed
+) {
+	std::vector<char> block(StreamBlockSize);
+	std::string pending;
+	Scanner scanner;
+	SCBL::Lexer scbll;
+
+	usize line = 1;
+	bool  eof  = false;
+	while (not eof and not p_stop) {
+		pending.append(block.data(), ReadBlock(block, p_stop, eof));
+		if (p_stop)
+			return;
+
+		scanner.Scan(pending);
+
+		const usize cut = eof? pending.size() : scanner.FindCut(pending, p_funcs);
+		if (cut == 0 and not eof)
+			continue;
+
+		std::unique_ptr<Batch> batch = std::make_unique<Batch>();
+		batch->code.assign(pending, 0, cut);
+		batch->line = line;
+		batch->last = eof;
+
+		pending.erase(0, cut);
+		scanner.Cut(cut);
+		line += std::count(batch->code.begin(), batch->code.end(), '\n');
+
+		batch->scblc.SetTyped(p_typed);
+		batch->error = scbll.TryLex(batch->code);
+		if (batch->error)
+			scbll.Locate(batch->error);
+		else
+			batch->error = batch->scblc.TryCompile(scbll);
+
+		// Nothing after a compiler error is run
+		if (batch->error)
+			batch->last = true;
+
+		const bool last = batch->last;
+		if (not p_queue.Push(batch, p_stop) or last)
+			return;
+	};
+};
@@ -0,0 +1,215 @@
+#include "app.hh"
+
+/*
+ *  --watch mode
+ *
+ *  The files are interpreted once, then a watcher thread waits for
+ *  inotify events about them. A changed file is compiled again from
+ *  its previous version (see program.hh), only the chunks around the
+ *  change are compiled, and the new program replaces the old one.
+ *  The main thread runs every file that changed with its newest
+ *  program, a run which already started keeps the program it started
+ *  with. Directories are watched, not the files, so files replaced by
+ *  editors (written into a new file which is renamed) are seen too.
+ */
+
+#ifdef PLATFORM_LINUX
+#	include <sys/inotify.h> // inotify_init1, inotify_add_watch, struct inotify_event
+#	include <poll.h> // poll, struct pollfd
+#	include <unistd.h> // read, close
+
+namespace {
+	struct Reload {
+	public:
+		usize file;
+		SCBL::Error error; // Compiler error of the new version, which was not swapped in
+	}; // struct Reload
+
+	struct WatchedFile {
+	public:
+		std::string dir, name;
+
+		int watch;
+	}; // struct WatchedFile
+
+	void SplitPath(const std::string &p_path, std::string &p_dir, std::string &p_name) {
+		const usize slash = p_path.rfind('/');
+		if (slash == std::string::npos) {
+			p_dir  = ".";
+			p_name = p_path;
+		} else {
+			p_dir  = slash == 0? "/" : p_path.substr(0, slash);
+			p_name = p_path.substr(slash + 1);
+		};
+	};
+};
+
+// public
+void Example::App::InterpretWatch(const std::vector<std::string> &p_files) {
+	for (const std::string &file : p_files) {
+		if (not FileExists(file)) {
+			Err()
+				<< "\nerror:\n  File '"
+				<< file
+				<< "' not found"
+				<< std::endl;
+
+			m_exitCode = FileNotFound;
+			return;
+		};
+	};
+
+	const int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+	if (fd < 0) {
+		ReportError("watch", SCBL::Error(
+			SCBL::ErrorCode::Generic,
+			SCBL::ErrorSubject::Text,
+			"Could not start watching the files"
+		));
+
+		return;
+	};
+
+	std::vector<WatchedFile> watched(p_files.size());
+	for (usize i = 0; i < p_files.size(); ++ i) {
+		SplitPath(p_files[i], watched[i].dir, watched[i].name);
+
+		// inotify returns the same watch for the same directory
+		watched[i].watch = inotify_add_watch(fd, watched[i].dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (watched[i].watch < 0) {
+			ReportError(p_files[i], SCBL::Error(
+				SCBL::ErrorCode::Generic,
+				SCBL::ErrorSubject::Text,
+				"Could not watch the directory '" + watched[i].dir + "'"
+			));
+
+			close(fd);
+			return;
+		};
+	};
+
+	FuncNames funcs;
+	for (const auto &name : m_scble.GetFuncNames())
+		funcs.insert(std::string(name));
+
+	// The newest program of every file, swapped atomically by
+	// the watcher and loaded by the main thread
+	std::vector<std::shared_ptr<const Program>> programs(p_files.size());
+
+	std::mutex mutex;
+	std::condition_variable reloaded;
+	std::vector<Reload> reloads;
+
+	// Compiles the file again from its last version, false if it
+	// could not be read or did not change
+	const auto reload = [&](const usize p_file, SCBL::Error &p_error) {
+		std::string code;
+		if (not ReadFile(p_files[p_file], code))
+			return false;
+
+		const std::shared_ptr<const Program> previous = std::atomic_load(&programs[p_file]);
+		if (previous != nullptr and previous->GetCode() == code)
+			return false;
+
+		std::shared_ptr<const Program> program;
+		p_error = Program::Compile(std::move(code), funcs, m_typed, program, previous.get());
+		if (not p_error)
+			std::atomic_store(&programs[p_file], program);
+
+		return true;
+	};
+
+	for (usize i = 0; i < p_files.size(); ++ i) {
+		SCBL::Error error;
+		if (reload(i, error))
+			reloads.push_back({i, error});
+	};
+
+	// Runs as long as the main thread, which never stops
+	std::thread watcher([&]() {
+		std::vector<char> buffer(64 * 1024);
+		pollfd pfd = {fd, POLLIN, 0};
+
+		while (true) {
+			if (poll(&pfd, 1, -1) < 0)
+				continue;
+
+			const ssize_t size = read(fd, buffer.data(), buffer.size());
+			if (size <= 0)
+				continue;
+
+			std::vector<bool> changed(p_files.size(), false);
+			for (ssize_t offset = 0; offset < size;) {
+				const inotify_event *event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+				offset += sizeof(inotify_event) + event->len;
+
+				if (event->len == 0)
+					continue;
+
+				for (usize i = 0; i < watched.size(); ++ i) {
+					if (watched[i].watch == event->wd and watched[i].name == event->name)
+						changed[i] = true;
+				};
+			};
+
+			for (usize i = 0; i < p_files.size(); ++ i) {
+				SCBL::Error error;
+				if (not changed[i] or not reload(i, error))
+					continue;
+
+				std::lock_guard<std::mutex> lock(mutex);
+				reloads.push_back({i, error});
+				reloaded.notify_one();
+			};
+		};
+	});
+
+	watcher.detach();
+
+	// Runs until the process is stopped
+	while (true) {
+		std::vector<Reload> pending;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			reloaded.wait(lock, [&reloads]() {
+				return not reloads.empty();
+			});
+
+			pending.swap(reloads);
+		};
+
+		for (const Reload &reload : pending) {
+			const std::string &file = p_files[reload.file];
+			if (reload.error) {
+				ReportError(file, reload.error);
+
+				continue;
+			};
+
+			const std::shared_ptr<const Program> program = std::atomic_load(&programs[reload.file]);
+
+			Err()
+				<< "\n" << file << ": compiled " << program->GetCompiledBytes()
+				<< " of " << program->GetCode().size() << " bytes, "
+				<< program->GetChunkCount() << " chunks"
+				<< std::endl;
+
+			const SCBL::Error error = program->Run(m_scble);
+			if (error)
+				ReportError(file, error);
+
+			if (m_memStats)
+				PrintMemStats(file);
+		};
+	};
+};
+#else // not PLATFORM_LINUX
+// public
+void Example::App::InterpretWatch(const std::vector<std::string> &p_files) {
+	ReportError("watch", SCBL::Error(
+		SCBL::ErrorCode::Generic,
+		SCBL::ErrorSubject::Text,
+		"Watching files needs inotify, which is only on Linux"
+	));
+};
+#endif // PLATFORM_LINUX
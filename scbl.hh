@@ -1,6 +1,6 @@
 /*
  *  SCBL - Simple Command Bar Language
- *  Version 2.1.4
+ *  Version 2.3.19
  *  Github: https://github.com/LordOfTrident/scbl2
  *
  *  Example under example/ folder, documentation in
@@ -13,15 +13,59 @@
 #include <string> // std::string
 #include <vector> // std::vector
 #include <unordered_map> // std::unordered_map
+#include <list> // std::list
+#include <algorithm> // std::fill, std::min
+#include <array> // std::array
+#include <utility> // std::index_sequence
+#include <string_view> // std::string_view
+#include <memory_resource> // std::pmr::memory_resource, std::pmr::polymorphic_allocator,
+                           // std::pmr::string, std::pmr::vector, std::pmr::unordered_map
 #include <cstdint> // std::int8_t, std::int16_t, std::int32_t, std::int64_t,
                    // std::uint8_t, std::uint16_t, std::uint32_t, std::uint64_t
 #include <cstddef> // std::size_t
 #include <variant> // std::variant
 #include <functional> // std::function
+#include <cstring> // std::memchr, std::memcpy
+#include <atomic> // std::atomic, std::atomic_thread_fence
+#include <thread> // std::thread
+#include <iterator> // std::make_move_iterator, std::istreambuf_iterator
+#include <memory> // std::unique_ptr, std::make_unique
+#include <chrono> // std::chrono::steady_clock
+#include <ostream> // std::ostream
+#include <fstream> // std::ofstream, std::ifstream
+#include <type_traits> // std::is_integral
+
+// FdSink writes with writev and Const::FromFile maps the file with
+// mmap, only on POSIX systems
+#if defined(__unix__) or defined(__APPLE__)
+#	define SCBL_HAS_WRITEV
+#	define SCBL_HAS_MMAP
+#	include <sys/uio.h> // writev, struct iovec
+#	include <climits> // IOV_MAX
+#	include <sys/mman.h> // mmap, munmap
+#	include <sys/stat.h> // fstat, struct stat
+#	include <fcntl.h> // open, O_RDONLY
+#	include <unistd.h> // STDOUT_FILENO, close
+#	include <cerrno> // errno, EINTR
+#endif
+
+// Trace timestamps are read from the CPU time stamp counter instead
+// of std::chrono::steady_clock if this is defined, only on x86
+#ifdef SCBL_TRACE_USE_TSC
+#	include <x86intrin.h> // __rdtsc
+#endif // SCBL_TRACE_USE_TSC
 
 #define SCBL_VERSION_MAJOR 2
-#define SCBL_VERSION_MINOR 1
-#define SCBL_VERSION_PATCH 4
+#define SCBL_VERSION_MINOR 3
+#define SCBL_VERSION_PATCH 19
+
+// Without exceptions only the Try* functions are available, they
+// report errors through SCBL::Error instead of throwing. This is
+// detected automatically when compiling with -fno-exceptions
+#if not defined(SCBL_DONT_USE_EXCEPTIONS) and \
+    not defined(__cpp_exceptions) and not defined(__EXCEPTIONS)
+#	define SCBL_DONT_USE_EXCEPTIONS
+#endif
 
 // Prevent long case repetition
 
@@ -120,17 +164,461 @@ namespace SCBL {
 
 	using usize = size_t;
 
-	using Callback = std::function<void(std::vector<u8>, void*)>;
+	// Read-only view of the parameters of a function call, only valid
+	// during the call
+	class ParamView {
+	public:
+		ParamView():
+			m_data(nullptr),
+			m_size(0)
+		{};
+
+		ParamView(const u8 *p_data, const usize p_size):
+			m_data(p_data),
+			m_size(p_size)
+		{};
+
+		ParamView(const std::vector<u8> &p_bytes):
+			m_data(p_bytes.data()),
+			m_size(p_bytes.size())
+		{};
+
+		ParamView(const std::pmr::vector<u8> &p_bytes):
+			m_data(p_bytes.data()),
+			m_size(p_bytes.size())
+		{};
+
+		const u8 *Data() const noexcept {
+			return m_data;
+		};
+
+		usize Size() const noexcept {
+			return m_size;
+		};
+
+		bool Empty() const noexcept {
+			return m_size == 0;
+		};
+
+		u8 operator[](const usize p_idx) const noexcept {
+			return m_data[p_idx];
+		};
+
+		// For range based for loops
+		const u8 *begin() const noexcept {
+			return m_data;
+		};
+
+		const u8 *end() const noexcept {
+			return m_data + m_size;
+		};
+
+	private:
+		const u8 *m_data;
+		usize m_size;
+	}; // class ParamView
+
+	// Parameters of a function call as views of the bytes in the code
+	// and of the constant values in their order, so constants are not
+	// copied. Only valid during the call
+	class ParamSegments {
+	public:
+		ParamSegments():
+			m_data(nullptr),
+			m_size(0),
+			m_bytes(0)
+		{};
+
+		ParamSegments(const ParamView *p_data, const usize p_size, const usize p_bytes):
+			m_data(p_data),
+			m_size(p_size),
+			m_bytes(p_bytes)
+		{};
+
+		const ParamView *Data() const noexcept {
+			return m_data;
+		};
+
+		// Amount of segments
+		usize Size() const noexcept {
+			return m_size;
+		};
+
+		// Size of all the segments together
+		usize Bytes() const noexcept {
+			return m_bytes;
+		};
+
+		bool Empty() const noexcept {
+			return m_bytes == 0;
+		};
+
+		const ParamView &operator[](const usize p_idx) const noexcept {
+			return m_data[p_idx];
+		};
+
+		// Copies the segments one after another into p_buffer
+		void Gather(std::vector<u8> &p_buffer) const {
+			p_buffer.clear();
+			p_buffer.reserve(m_bytes);
+			for (const ParamView &segment : *this)
+				p_buffer.insert(p_buffer.end(), segment.begin(), segment.end());
+		};
+
+		// For range based for loops
+		const ParamView *begin() const noexcept {
+			return m_data;
+		};
+
+		const ParamView *end() const noexcept {
+			return m_data + m_size;
+		};
+
+	private:
+		const ParamView *m_data;
+		usize m_size, m_bytes;
+	}; // class ParamSegments
+
+	// Parameters of a run of consecutive calls of one function, one frame
+	// per call in their order. Only valid during the call
+	class ParamFrames {
+	public:
+		ParamFrames():
+			m_data(nullptr),
+			m_size(0),
+			m_bytes(0)
+		{};
+
+		ParamFrames(const ParamView *p_data, const usize p_size, const usize p_bytes):
+			m_data(p_data),
+			m_size(p_size),
+			m_bytes(p_bytes)
+		{};
+
+		const ParamView *Data() const noexcept {
+			return m_data;
+		};
+
+		// Amount of frames
+		usize Size() const noexcept {
+			return m_size;
+		};
+
+		// Size of all the frames together
+		usize Bytes() const noexcept {
+			return m_bytes;
+		};
+
+		const ParamView &operator[](const usize p_idx) const noexcept {
+			return m_data[p_idx];
+		};
+
+		// For range based for loops
+		const ParamView *begin() const noexcept {
+			return m_data;
+		};
+
+		const ParamView *end() const noexcept {
+			return m_data + m_size;
+		};
+
+	private:
+		const ParamView *m_data;
+		usize m_size, m_bytes;
+	}; // class ParamFrames
+
+	// How integers wider than a byte are stored in the parameters. Big
+	// endian and packed by default, or in the byte order of the machine
+	// and aligned to their size from the start of the parameters, so
+	// they can be read in place (see ParamHandler::TryGetNextSpan)
+	enum class Layout : u8 {
+		BigEndian,
+		Native
+	}; // enum class Layout
+
+	// Kind of an argument in the typed encoding (see Compiler::SetTyped)
+	enum class ArgKind : u8 {
+		Int,
+		Str,  // A 32 bit length in the layout, then the characters
+		Bytes // Constants which are neither numbers nor strings
+	}; // enum class ArgKind
+
+	// Entry of the argument table at the end of typed parameters. The
+	// table is followed by the 32 bit count of its entries, both in the
+	// byte order of the machine
+	struct ArgDesc {
+	public:
+		// Packs the kind and width into a StructcodeType::Arg
+		static u8 Tag(const ArgKind p_kind, const u8 p_width) {
+			return static_cast<u8>(p_kind) | p_width << 4;
+		};
+
+		u32 offset; // From the start of the parameters
+		u32 size;   // In bytes, with the length of strings
+		ArgKind kind;
+		u8 width;   // Of the integer, the characters or the list elements
+		u8 reserved[2];
+	}; // struct ArgDesc
+
+	using Callback        = std::function<void(ParamView, void*)>;
+	using SegmentCallback = std::function<void(ParamSegments, void*)>;
+	using BatchCallback   = std::function<void(ParamFrames, void*)>;
+
+	inline std::string UnexpectedErrorMsg(const std::string &p_unexpect) {
+		return (std::string)"Unexpected " + p_unexpect;
+	};
+
+	inline std::string ExpectedErrorMsg(
+		const std::string &p_expect,
+		const std::string &p_got
+	) {
+		return (std::string)
+			"Expected " + p_expect + ", got " + p_got + " instead";
+	};
+
+	enum class ErrorCode : u8 {
+		None,
+
+		// Lexer and compiler errors
+		UnexpectedChar,
+		UnexpectedToken,
+		ExpectedStrEnd,
+		ExpectedCommEnd,
+		ExpectedDecDigit,
+		ExpectedHexDigit,
+		ExpectedSize,
+		InvalidSize,
+		IntOutOfRange,
+		IntTooBigForSize,
+		ExpectedSlotName,
+		TooManySlots,
+
+		// Runtime errors
+		UnexpectedScode,
+		NoSuchFunc,
+		NoSuchConst,
+		UnboundSlot,
+
+		// Generic errors
+		Generic,
+		InvalidName,
+		FuncNameTaken,
+		ConstNameTaken,
+		InvalidConstSize,
+		OutOfParams,
+		CantReadFile,
+		WrongParamType,
+		NoSuchSlot,
+		TooManyRegisters,
+		InvalidArgTable,
+		InvalidPureFunc
+	}; // enum class ErrorCode
+
+	// What an error is about, so the message can be built later
+	enum class ErrorSubject : u8 {
+		None,
+		EndOfFile,
+		Char,
+		Int,
+		Str,
+		Id,
+		Sym,
+		Text
+	}; // enum class ErrorSubject
+
+	// Result of the Try* functions, evaluates to true if an error occured.
+	// Only the code, subject and location are stored, the message is
+	// formatted when Message() is called
+	struct Error {
+	public:
+		Error():
+			code(ErrorCode::None),
+			subject(ErrorSubject::None),
+			ch(0),
+			num(0),
+			offset(0),
+			line(0),
+			col(0),
+			idx(0)
+		{};
+
+		Error(
+			const ErrorCode p_code,
+			const ErrorSubject p_subject = ErrorSubject::None,
+			const std::string_view p_text = ""
+		):
+			code(p_code),
+			subject(p_subject),
+			ch(0),
+			num(0),
+			text(p_text),
+			offset(0),
+			line(0),
+			col(0),
+			idx(0)
+		{};
+
+		explicit operator bool() const noexcept {
+			return code != ErrorCode::None;
+		};
+
+		bool IsCompilerError() const noexcept {
+			return code >= ErrorCode::UnexpectedChar and code <= ErrorCode::TooManySlots;
+		};
+
+		bool IsRuntimeError() const noexcept {
+			return code >= ErrorCode::UnexpectedScode and code <= ErrorCode::UnboundSlot;
+		};
+
+		std::string SubjectName() const {
+			switch (subject) {
+			case ErrorSubject::EndOfFile: return "end of file";
+			case ErrorSubject::Int:       return "number " + std::to_string(num);
+			case ErrorSubject::Str:       return "string '" + text + "'";
+			case ErrorSubject::Id:        return "identifier '" + text + "'";
+			case ErrorSubject::Sym:       return (std::string)"symbol '" + ch + "'";
+			case ErrorSubject::Text:      return text;
+
+			case ErrorSubject::Char:
+				switch (ch) {
+				case '\0': return "null terminator";
+				case '\a': return "bell code";
+				case '\b': return "backspace";
+				case '\e': return "escape";
+				case '\f': return "formfeed page break";
+				case '\n': return "new line";
+				case '\r': return "carriage return";
+				case '\t': return "tab";
+				case '\v': return "vertical tab";
+
+				default: return (std::string)"character '" + ch + "'";
+				};
+
+			default: return "nothing";
+			};
+		};
+
+		std::string Message() const {
+			switch (code) {
+			case ErrorCode::None: return "No error";
+
+			case ErrorCode::UnexpectedChar:
+			case ErrorCode::UnexpectedToken:
+			case ErrorCode::UnexpectedScode:
+				return UnexpectedErrorMsg(SubjectName());
+
+			case ErrorCode::ExpectedStrEnd:
+				return ExpectedErrorMsg("string end", SubjectName());
+
+			case ErrorCode::ExpectedCommEnd:
+				return ExpectedErrorMsg("multi-line comment end", SubjectName());
+
+			case ErrorCode::ExpectedDecDigit:
+				return ExpectedErrorMsg("a dec digit", SubjectName());
+
+			case ErrorCode::ExpectedHexDigit:
+				return ExpectedErrorMsg("a hex digit", SubjectName());
+
+			case ErrorCode::ExpectedSize:
+				return ExpectedErrorMsg("size specifier", SubjectName());
+
+			case ErrorCode::InvalidSize:
+				return ExpectedErrorMsg("size of 1, 2, 4 or 8 bytes", SubjectName());
+
+			case ErrorCode::IntOutOfRange:
+				return "Integer " + text + " is too large";
+
+			// The size is stored in ch
+			case ErrorCode::IntTooBigForSize:
+				return "Integer " + std::to_string(num) + " does not fit in " +
+					std::to_string(static_cast<int>(ch)) + " bytes";
+
+			case ErrorCode::ExpectedSlotName:
+				return ExpectedErrorMsg("slot name after '@'", SubjectName());
+
+			case ErrorCode::TooManySlots:
+				return "More than 256 slots, at " + SubjectName();
+
+			case ErrorCode::NoSuchFunc:
+				return "No function with " + SubjectName() + " exists";
+
+			case ErrorCode::NoSuchConst:
+				return "No constant with " + SubjectName() + " exists";
+
+			case ErrorCode::UnboundSlot:
+				return "No value is bound to the slot '@" + text + "'";
+
+			case ErrorCode::NoSuchSlot:
+				return "No slot named '" + text + "' exists";
+
+			case ErrorCode::TooManyRegisters:
+				return "No register left for '" + text + "'";
+
+			case ErrorCode::InvalidName:
+				return "Invalid characters in the name '" + text + "'";
+
+			case ErrorCode::FuncNameTaken:
+				return "Function with the name '" + text + "' already exists";
+
+			case ErrorCode::ConstNameTaken:
+				return "Constant with the name '" + text + "' already exists";
+
+			case ErrorCode::InvalidConstSize:
+				return "Invalid amount of bytes: " + std::to_string(num);
+
+			case ErrorCode::OutOfParams: return "Out of parameters";
+
+			case ErrorCode::CantReadFile:
+				return "Could not read the file '" + text + "'";
+
+			case ErrorCode::WrongParamType:
+				return "Parameter " + std::to_string(num) + " is of a different type";
+
+			case ErrorCode::InvalidArgTable:
+				if (subject == ErrorSubject::Int)
+					return "Parameter " + std::to_string(num) + " is outside of the parameters";
+				else
+					return "Invalid argument table";
+
+			case ErrorCode::InvalidPureFunc:
+				return "Pure function '" + text + "' needs a callback, not a segment or batch one";
+
+			default: return SubjectName();
+			};
+		};
+
+		ErrorCode code;
+		ErrorSubject subject;
+
+		char ch;          // ErrorSubject::Char and ErrorSubject::Sym
+		u64 num;          // ErrorSubject::Int
+		std::string text; // Identifier, string or generic message
+
+		usize offset;    // Byte offset in the source
+		usize line, col; // Filled in from the offset by LineIndex::Locate
+		usize idx;       // Structcode index of runtime errors
+	}; // struct Error
 
 	class Exception {
 		public:
-			Exception(const std::string &p_message):
-				m_message(p_message)
+			Exception(
+				const std::string &p_message,
+				const ErrorCode p_code = ErrorCode::Generic
+			):
+				m_error(p_code, ErrorSubject::Text, p_message)
+			{};
+
+			Exception(const Error &p_error):
+				m_error(p_error)
 			{};
 
 			~Exception() {};
 
-			const std::string& What() const noexcept {
+			// The message is only formatted the first time it is asked for
+			const std::string& What() const {
+				if (m_message.empty())
+					m_message = m_error.Message();
+
 				return m_message;
 			};
 
@@ -138,8 +626,17 @@ namespace SCBL {
 				return What();
 			};
 
+			ErrorCode Code() const noexcept {
+				return m_error.code;
+			};
+
+			const Error &GetError() const noexcept {
+				return m_error;
+			};
+
 		protected:
-			std::string m_message;
+			Error m_error;
+			mutable std::string m_message;
 	}; // class Exception
 
 	class CompilerException: public Exception {
@@ -149,23 +646,25 @@ namespace SCBL {
 				const usize p_line,
 				const usize p_col
 			):
-				Exception(p_message),
-				m_line(p_line),
-				m_col(p_col)
+				Exception(p_message)
+			{
+				m_error.line = p_line;
+				m_error.col  = p_col;
+			};
+
+			CompilerException(const Error &p_error):
+				Exception(p_error)
 			{};
 
 			~CompilerException() {};
 
 			usize Line() const noexcept {
-				return m_line;
+				return m_error.line;
 			};
 
 			usize Col() const noexcept {
-				return m_col;
+				return m_error.col;
 			};
-
-		protected:
-			usize m_line, m_col;
 	}; // class CompilerException
 
 	class RuntimeException: public Exception {
@@ -174,21 +673,283 @@ namespace SCBL {
 				const std::string &p_message,
 				const usize p_idx
 			):
-				Exception(p_message),
-				m_idx(p_idx)
+				Exception(p_message)
+			{
+				m_error.idx = p_idx;
+			};
+
+			RuntimeException(const Error &p_error):
+				Exception(p_error)
 			{};
 
 			~RuntimeException() {};
 
 			usize Idx() const noexcept {
-				return m_idx;
+				return m_error.idx;
 			};
-
-		protected:
-			usize m_idx;
 	}; // class RuntimeException
 
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+	// Throws the exception class matching the kind of the error
+	[[noreturn]] inline void ThrowError(const Error &p_error) {
+		if (p_error.IsCompilerError())
+			throw CompilerException(p_error);
+		else if (p_error.IsRuntimeError())
+			throw RuntimeException(p_error);
+		else
+			throw Exception(p_error);
+	};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+	// Approximate heap memory used by a part of the interpreter
+	struct MemUsage {
+	public:
+		usize count = 0; // Amount of elements
+		usize bytes = 0; // Bytes allocated for them, including their strings
+	}; // struct MemUsage
+
 	namespace Tools {
+		// Heap bytes of a string, 0 if it fits in the small string buffer
+		inline usize StringBytes(const std::pmr::string &p_str) {
+			static const usize smallCapacity = std::pmr::string().capacity();
+
+			return p_str.capacity() > smallCapacity? p_str.capacity() + 1 : 0;
+		};
+
+		template <typename T>
+		inline usize VectorBytes(const T &p_vector) {
+			return p_vector.capacity() * sizeof(typename T::value_type);
+		};
+
+		// The buckets and one node per element, a node being the
+		// element, the next node pointer and the cached hash
+		template <typename T>
+		inline usize MapBytes(const T &p_map) {
+			return p_map.bucket_count() * sizeof(void*) +
+				p_map.size() * (sizeof(typename T::value_type) + sizeof(void*) + sizeof(usize));
+		};
+
+		// SWAR (SIMD within a register) helpers for parsing 8 digits
+		// at once and probing SymbolTable, the first char of a chunk
+		// is in the lowest byte
+		namespace Swar {
+			static constexpr const u64 Ones = 0x0101010101010101;
+			static constexpr const u64 High = 0x8080808080808080;
+
+			inline u64 Load(const char *p_chars) {
+				u64 chunk;
+				std::memcpy(&chunk, p_chars, 8);
+
+#if defined(__BYTE_ORDER__) and __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				chunk = __builtin_bswap64(chunk);
+#endif
+
+				return chunk;
+			};
+
+			// High bit of each byte set if it is within p_min and p_max,
+			// the bytes have to be ASCII
+			inline u64 InRange(const u64 p_chunk, const u8 p_min, const u8 p_max) {
+				const u64 atLeastMin = p_chunk + Ones * (0x80 - p_min);
+				const u64 aboveMax   = p_chunk + Ones * (0x7F - p_max);
+
+				return atLeastMin & ~aboveMax & High;
+			};
+
+			// High bit of each byte equal to p_byte, which has to be ASCII.
+			// Bytes after an equal one can be set too, so the matches
+			// have to be checked
+			inline u64 MatchByte(const u64 p_chunk, const u8 p_byte) {
+				const u64 diff = p_chunk ^ (Ones * p_byte);
+
+				return (diff - Ones) & ~diff & High;
+			};
+
+			// Index of the lowest byte with its high bit set in p_bits
+			inline usize FirstByte(const u64 p_bits) {
+				return __builtin_ctzll(p_bits) / 8;
+			};
+
+			inline bool IsDec(const u64 p_chunk) {
+				return (p_chunk & High) == 0 and InRange(p_chunk, '0', '9') == High;
+			};
+
+			inline bool IsHex(const u64 p_chunk) {
+				if (p_chunk & High)
+					return false;
+
+				return (
+					InRange(p_chunk, '0', '9') |
+					InRange(p_chunk, 'A', 'F') |
+					InRange(p_chunk, 'a', 'f')
+				) == High;
+			};
+
+			// Combines the digits in pairs, fours and then eights
+			inline u64 ParseDec(u64 p_chunk) {
+				p_chunk -= Ones * '0';
+				p_chunk = (p_chunk * 10 + (p_chunk >> 010)) & 0x00FF00FF00FF00FF;
+				p_chunk = (p_chunk * 100 + (p_chunk >> 020)) & 0x0000FFFF0000FFFF;
+
+				return (p_chunk * 10000 + (p_chunk >> 040)) & 0xFFFFFFFF;
+			};
+
+			inline u64 ParseHex(u64 p_chunk) {
+				// Letters have the 0x40 bit set, their low nibble is 9 less
+				// than their value
+				const u64 letters = (p_chunk & (Ones * 0x40)) >> 6;
+				p_chunk = (p_chunk & (Ones * 0x0F)) + letters * 9;
+
+				p_chunk = ((p_chunk << 4)  | (p_chunk >> 010)) & 0x00FF00FF00FF00FF;
+				p_chunk = ((p_chunk << 010) | (p_chunk >> 020)) & 0x0000FFFF0000FFFF;
+
+				return ((p_chunk << 020) | (p_chunk >> 040)) & 0xFFFFFFFF;
+			};
+		}; // namespace Swar
+
+		// Names are short, so they are hashed 8 bytes at a time
+		// with one multiply each
+		inline u64 HashName(const std::string_view p_name) {
+			static constexpr const u64 Mul = 0x9E3779B97F4A7C15;
+
+			u64 hash = p_name.size() * Mul;
+			for (usize i = 0; i < p_name.size(); i += 8) {
+				u64 chunk = 0;
+				std::memcpy(&chunk, p_name.data() + i, std::min<usize>(8, p_name.size() - i));
+
+				hash  = (hash ^ chunk) * Mul;
+				hash ^= hash >> 040;
+			};
+
+			return hash;
+		};
+
+		// p_offset rounded up to a multiple of p_align, a power of 2
+		inline usize AlignUp(const usize p_offset, const usize p_align) {
+			return (p_offset + p_align - 1) & ~(p_align - 1);
+		};
+
+		// Writes the low p_size bytes of the number in the byte
+		// order of the machine
+		inline void StoreNative(const u64 p_value, const u8 p_size, u8 *p_bytes) {
+			switch (p_size) {
+			case 2: { const u16 value = p_value; std::memcpy(p_bytes, &value, 2); }; break;
+			case 4: { const u32 value = p_value; std::memcpy(p_bytes, &value, 4); }; break;
+			case 8: std::memcpy(p_bytes, &p_value, 8); break;
+
+			default: p_bytes[0] = p_value; break;
+			};
+		};
+
+		inline u64 LoadNative(const u8 *p_bytes, const u8 p_size) {
+			switch (p_size) {
+			case 2: { u16 value; std::memcpy(&value, p_bytes, 2); return value; };
+			case 4: { u32 value; std::memcpy(&value, p_bytes, 4); return value; };
+			case 8: { u64 value; std::memcpy(&value, p_bytes, 8); return value; };
+
+			default: return p_bytes[0];
+			};
+		};
+
+		// Calls p_func with every index below p_count, spread over up to
+		// p_threads threads (including the calling one)
+		template <typename T>
+		inline void ParallelFor(const usize p_threads, const usize p_count, const T &p_func) {
+			std::atomic<usize> next(0);
+			const auto worker = [&]() {
+				for (usize i = next ++; i < p_count; i = next ++)
+					p_func(i);
+			};
+
+			std::vector<std::thread> threads;
+			for (usize i = 1; i < p_threads and i < p_count; ++ i)
+				threads.emplace_back(worker);
+
+			worker();
+
+			for (std::thread &thread : threads)
+				thread.join();
+		};
+
+		// Whether the code ends inside of a multi-line comment. Strings and
+		// single line comments end at a new line, they are only followed
+		// so a /* in them is not taken for a comment
+		inline bool EndsInComment(const char *p_begin, const char *p_end, const bool p_inComment) {
+			enum class State : u8 {
+				Code,
+				Slash,
+				Str,
+				StrEscape,
+				Comm,
+				CommMul,
+				CommMulStar
+			} state = p_inComment? State::CommMul : State::Code;
+
+			for (const char *it = p_begin; it < p_end; ++ it) {
+				switch (state) {
+				case State::Code:
+					switch (*it) {
+					case '"': state = State::Str;   break;
+					case '#': state = State::Comm;  break;
+					case '/': state = State::Slash; break;
+					};
+
+					break;
+
+				case State::Slash:
+					switch (*it) {
+					case '*': state = State::CommMul; break;
+					case '/': state = State::Comm;    break;
+
+					default: state = State::Code; break;
+					};
+
+					break;
+
+				case State::Str:
+					switch (*it) {
+					case '\\': state = State::StrEscape; break;
+					case '"':  case '\n': state = State::Code; break;
+					};
+
+					break;
+
+				case State::StrEscape:
+					state = *it == '\n'? State::Code : State::Str;
+					break;
+
+				case State::Comm:
+					// The rest of the line is skipped at once
+					it = static_cast<const char*>(std::memchr(it, '\n', p_end - it));
+					if (it == nullptr)
+						return false;
+
+					state = State::Code;
+					break;
+
+				case State::CommMul:
+					it = static_cast<const char*>(std::memchr(it, '*', p_end - it));
+					if (it == nullptr)
+						return true;
+
+					state = State::CommMulStar;
+					break;
+
+				case State::CommMulStar:
+					switch (*it) {
+					case '/': state = State::Code; break;
+					case '*': break;
+
+					default: state = State::CommMul; break;
+					};
+
+					break;
+				};
+			};
+
+			return state == State::CommMul or state == State::CommMulStar;
+		};
+
 		// Byte Splitter and Joiner
 		class ByteSJ {
 		public:
@@ -212,6 +973,32 @@ namespace SCBL {
 				return m_bytes != nullptr;
 			};
 
+			// The Split and Join functions use big endian unless
+			// p_layout is Layout::Native
+			void Split16(const u16 p_num, const Layout p_layout) {
+				SplitNative(p_num, 2, p_layout);
+			};
+
+			void Split32(const u32 p_num, const Layout p_layout) {
+				SplitNative(p_num, 4, p_layout);
+			};
+
+			void Split64(const u64 p_num, const Layout p_layout) {
+				SplitNative(p_num, 8, p_layout);
+			};
+
+			u16 Join16(const Layout p_layout) {
+				return p_layout == Layout::Native? LoadNative(m_bytes->data(), 2) : Join16();
+			};
+
+			u32 Join32(const Layout p_layout) {
+				return p_layout == Layout::Native? LoadNative(m_bytes->data(), 4) : Join32();
+			};
+
+			u64 Join64(const Layout p_layout) {
+				return p_layout == Layout::Native? LoadNative(m_bytes->data(), 8) : Join64();
+			};
+
 			void Split16(const u16 p_num) {
 				*m_bytes = {
 					static_cast<u8>((p_num & 0xFF00) >> 010),
@@ -268,929 +1055,4342 @@ namespace SCBL {
 			};
 
 		private:
-			std::vector<u8> *m_bytes;
-		}; // class ByteSJ
+			void SplitNative(const u64 p_num, const u8 p_size, const Layout p_layout) {
+				if (p_layout != Layout::Native) {
+					switch (p_size) {
+					case 2:  Split16(p_num); break;
+					case 4:  Split32(p_num); break;
+					default: Split64(p_num); break;
+					};
+
+					return;
+				};
+
+				m_bytes->resize(p_size);
+				StoreNative(p_num, p_size, m_bytes->data());
+			};
+
+			std::vector<u8> *m_bytes;
+		}; // class ByteSJ
 
 		class ParamHandler {
 		public:
-			ParamHandler() {};
-
-			ParamHandler(const std::vector<u8> &p_params):
-				m_params(&p_params),
-				m_it(p_params.cbegin())
+			ParamHandler():
+				m_begin(nullptr),
+				m_it(nullptr),
+				m_end(nullptr),
+				m_args(nullptr),
+				m_argCount(0),
+				m_layout(Layout::BigEndian)
 			{};
 
-			void SetParams(const std::vector<u8> &p_params) {
-				m_params = &p_params;
-				m_it = p_params.cbegin();
+			// p_layout has to be the layout the code was compiled with
+			ParamHandler(const ParamView p_params, const Layout p_layout = Layout::BigEndian):
+				m_layout(p_layout)
+			{
+				SetParams(p_params);
 			};
 
-			u8 GetNextParam8() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
-
-				const u8 toReturn = *m_it;
-				++ m_it;
+			void SetLayout(const Layout p_layout) {
+				m_layout = p_layout;
+			};
 
-				return toReturn;
+			Layout GetLayout() const {
+				return m_layout;
 			};
 
-			u16 GetNextParam16() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
+			void SetParams(const ParamView p_params) {
+				m_begin = p_params.Data();
+				m_it    = m_begin;
+				m_end   = m_begin + p_params.Size();
 
-				std::vector<u8> bytes;
+				m_args     = nullptr;
+				m_argCount = 0;
+			};
 
-				for (u8 i = 0; i < 2; ++ i, ++ m_it) {
-					if (m_it == m_params->cend())
-						throw Exception("Out of parameters");
+			// The Try functions return false instead of throwing
+			// when there are not enough parameters left
+			bool TryGetNextParam8(u8 &p_param) {
+				if (m_it == m_end)
+					return false;
 
-					bytes.push_back(*m_it);
-				};
+				p_param = *m_it;
+				++ m_it;
 
-				m_byteSJ.SetList(bytes);
-				return m_byteSJ.Join16();
+				return true;
 			};
 
-			u32 GetNextParam32() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
-
-				std::vector<u8> bytes;
+			bool TryGetNextParam16(u16 &p_param) {
+				if (not Skip(2))
+					return false;
 
-				for (u8 i = 0; i < 4; ++ i, ++ m_it) {
-					if (m_it == m_params->cend())
-						throw Exception("Out of parameters");
+				p_param = static_cast<u16>(Join(2));
+				return true;
+			};
 
-					bytes.push_back(*m_it);
-				};
+			bool TryGetNextParam32(u32 &p_param) {
+				if (not Skip(4))
+					return false;
 
-				m_byteSJ.SetList(bytes);
-				return m_byteSJ.Join32();
+				p_param = static_cast<u32>(Join(4));
+				return true;
 			};
 
-			u64 GetNextParam64() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
+			bool TryGetNextParam64(u64 &p_param) {
+				if (not Skip(8))
+					return false;
+
+				p_param = Join(8);
+				return true;
+			};
 
-				std::vector<u8> bytes;
+			// Points p_data at the next p_count integers of type T, without
+			// copying them. Only for Layout::Native, where they are stored
+			// the way T is and aligned for it (as long as the parameters
+			// are, which they are with the default memory resource)
+			template <typename T>
+			bool TryGetNextSpan(const T *&p_data, const usize p_count) {
+				static_assert(
+					std::is_integral<T>::value and sizeof(T) <= 8,
+					"Spans are of integers up to 8 bytes"
+				);
 
-				for (u8 i = 0; i < 8; ++ i, ++ m_it) {
-					if (m_it == m_params->cend())
-						throw Exception("Out of parameters");
+				if (not Skip(sizeof(T)) or Remaining() / sizeof(T) < p_count)
+					return false;
 
-					bytes.push_back(*m_it);
-				};
+				p_data = reinterpret_cast<const T*>(m_it);
+				m_it  += p_count * sizeof(T);
 
-				m_byteSJ.SetList(bytes);
-				return m_byteSJ.Join64();
+				return true;
 			};
 
-			u64 GetNextParamInt() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
-
-				std::vector<u8> bytes;
-				u8 size;
+			bool TryGetNextParamInt(u64 &p_param) {
+				const usize remaining = Remaining();
+				if (remaining == 0)
+					return false;
 
-				for (size = 0; size < 8; ++ size, ++ m_it) {
-					if (m_it == m_params->cend())
-						break;
+				// The largest size which fits after its padding
+				if (m_layout == Layout::Native) {
+					for (u8 size = 8; size > 0; size /= 2) {
+						if (Skip(size)) {
+							p_param = Join(size);
 
-					bytes.push_back(*m_it);
+							return true;
+						};
+					};
 				};
 
-				if (bytes.empty())
-					throw Exception("Out of parameters");
-
-				m_byteSJ.SetList(bytes);
+				// Takes up to 8 bytes, but only joins
+				// the largest integer size that fits
+				const u8 size = remaining < 8? remaining : 8;
+				const u8 *it  = m_it;
+				m_it += size;
 
 				switch (size) {
-				case 1: return bytes[0];
+				case 1: p_param = it[0]; break;
 				case 2: case 3:
-					return m_byteSJ.Join16();
+					p_param = JoinAt(it, 2);
+					break;
 
 				case 4: case 5:
 				case 6: case 7:
-					return m_byteSJ.Join32();
+					p_param = JoinAt(it, 4);
+					break;
 
 				case 8: default:
-					return m_byteSJ.Join64();
+					p_param = JoinAt(it, 8);
+					break;
 				};
-			};
 
-			std::string GetNextParamStr() {
-				if (m_it == m_params->cend())
-					throw Exception("Out of parameters");
+				return true;
+			};
 
-				std::string str;
-				for (; m_it != m_params->cend(); ++ m_it) {
-					if (*m_it == 0) {
-						++ m_it;
-						break;
+			bool TryGetNextParamStr(std::string &p_param) {
+				if (m_it == m_end)
+					return false;
+
+				// Typed parameters are decoded like TryGetArgStr does,
+				// with the width and padding of their argument
+				if (m_args != nullptr) {
+					const u8 *start = m_it;
+
+					ArgDesc desc;
+					usize   idx;
+					if (
+						not Skip(4) or
+						not TryFindStrArg(m_it - m_begin, idx, desc) or
+						desc.size > static_cast<usize>(m_end - m_it) or
+						not TryGetArgStr(idx, p_param)
+					) {
+						m_it = start;
+
+						return false;
 					};
 
-					str += *m_it;
+					m_it += desc.size;
+
+					return true;
+				};
+
+				const u8 *start = m_it;
+				for (; m_it != m_end; ++ m_it) {
+					if (*m_it == 0)
+						break;
 				};
 
-				return str;
+				p_param.assign(start, m_it);
+				if (m_it != m_end)
+					++ m_it; // Skip the null terminator
+
+				return true;
 			};
 
-			void ResetCounter() {
-				m_it = m_params->cbegin();
+			// Reads the argument table of typed parameters (see
+			// Compiler::SetTyped), false if there is none or one of its
+			// arguments is not inside of the parameters before it. The
+			// parameters then end before the table, and the arguments can
+			// be read in any order without scanning the ones before them.
+			// Only for typed code, other parameters could look like a table
+			bool TryReadArgs() {
+				if (m_args != nullptr)
+					return true;
+
+				const usize size = m_end - m_begin;
+				if (size < 4)
+					return false;
+
+				const usize count = LoadNative(m_end - 4, 4);
+				if ((size - 4) / sizeof(ArgDesc) < count)
+					return false;
+
+				const u8   *args   = m_end - 4 - count * sizeof(ArgDesc);
+				const usize params = args - m_begin;
+				for (usize i = 0; i < count; ++ i) {
+					ArgDesc desc;
+					std::memcpy(&desc, args + i * sizeof(ArgDesc), sizeof(ArgDesc));
+
+					if (not IsValidArg(desc, params))
+						return false;
+				};
+
+				m_end      = args;
+				m_args     = args;
+				m_argCount = count;
+
+				return true;
 			};
 
-		private:
-			const std::vector<u8> *m_params;
-			std::vector<u8>::const_iterator m_it;
+			usize GetArgCount() const {
+				return m_argCount;
+			};
 
-			ByteSJ m_byteSJ;
-		}; // class ParamHandler
-	}; // namespaces Tools
+			bool TryGetArg(const usize p_idx, ArgDesc &p_desc) const {
+				if (p_idx >= m_argCount)
+					return false;
 
+				std::memcpy(&p_desc, m_args + p_idx * sizeof(ArgDesc), sizeof(ArgDesc));
 
-	inline std::string UnexpectedErrorMsg(const std::string &p_unexpect) {
-		return (std::string)"Unexpected " + p_unexpect;
-	};
+				return true;
+			};
 
-	inline std::string ExpectedErrorMsg(
-		const std::string &p_expect,
-		const std::string &p_got
-	) {
-		return (std::string)
-			"Expected " + p_expect + ", got " + p_got + " instead";
-	};
+			// The next parameter read is the argument p_idx
+			bool TrySeekArg(const usize p_idx) {
+				ArgDesc desc;
+				if (not TryGetArg(p_idx, desc))
+					return false;
 
-	enum class TokenType : u8 {
-		Int,
-		Id,
-		Str,
-		Sym
-	}; // enum class TokenType
+				m_it = m_begin + desc.offset;
 
-	struct Token {
-	public:
-		Token() {};
+				return true;
+			};
 
-		Token(
-			const TokenType p_type,
-			const std::variant<u64, std::string, char> p_data,
-			const usize p_line,
-			const usize p_col
-		):
-			type(p_type),
-			data(p_data),
-			line(p_line),
-			col(p_col)
-		{};
+			// The TryGetArg* functions return false if there is no such
+			// argument or it is of a different kind
+			bool TryGetArgInt(const usize p_idx, u64 &p_param) const {
+				ArgDesc desc;
+				if (not TryGetArg(p_idx, desc) or desc.kind != ArgKind::Int)
+					return false;
 
-		TokenType type;
-		std::variant<u64, std::string, char> data;
+				p_param = Load(m_begin + desc.offset, desc.width);
 
-		usize line, col;
-	}; // class Token
+				return true;
+			};
 
-	class Lexer {
-	public:
-		Lexer() {};
+			// The bytes of the argument in place, the characters of strings
+			bool TryGetArgView(const usize p_idx, ParamView &p_param) const {
+				ArgDesc desc;
+				if (not TryGetArg(p_idx, desc))
+					return false;
 
-		Lexer(const std::string &p_code) {
-			Lex(p_code);
-		};
+				if (desc.kind != ArgKind::Str) {
+					p_param = ParamView(m_begin + desc.offset, desc.size);
 
-		void Lex(const std::string &p_code) {
-			m_tokens.clear();
+					return true;
+				};
 
-			m_totalCol = 0;
-			m_line = 1; // Line initialised to 1
-			m_col = 0;  // because its incremented
-			            // every time a new line char
-			            // is found, while totalCol is
-			            // incremented at the start of
-			            // the for loop.
+				// The length is not checked by TryReadArgs
+				if (not IsLoadable(desc.width) or desc.size < 4)
+					return false;
 
-			m_code = &p_code;
-			m_escape = false;
-			for (
-				m_it = p_code.cbegin();
-				m_it != p_code.cend();
-				Inc()
-			) {
-				m_col = m_totalCol;
+				const u64 length = Load(m_begin + desc.offset, 4);
+				usize chars = desc.offset + 4;
+				if (m_layout == Layout::Native)
+					chars = AlignUp(chars, desc.width);
 
-				switch (*m_it) {
-				case '\n':
-					++ m_line;
-					m_totalCol = 0;
+				if (chars - desc.offset + length * desc.width > desc.size)
+					return false;
 
-					// Fall through
-				case '\t': case '\r': case ' ':
-					break;
+				p_param = ParamView(m_begin + chars, length * desc.width);
 
-				case ':': case '~':
-					m_tokens.push_back(Token(
-						TokenType::Sym,
-						*m_it, m_line, m_col
-					));
+				return true;
+			};
 
-					break;
+			bool TryGetArgStr(const usize p_idx, std::string &p_param) const {
+				ArgDesc desc;
+				ParamView chars;
+				if (
+					not TryGetArg(p_idx, desc) or
+					desc.kind != ArgKind::Str or
+					not TryGetArgView(p_idx, chars)
+				)
+					return false;
 
-				case '#': Inc(); LexComm();     break;
-				case '/': Inc(); LexFwdSlash(); break;
-				case '"': Inc(); LexStr();      break;
-				case '$': Inc(); LexHex();      break;
-				case SCBL_NAME_CHARS: LexId();  break;
-				case SCBL_DEC_CHARS: LexDec();  break;
+				if (desc.width == 1) {
+					p_param.assign(chars.begin(), chars.end());
 
-				default:
-					throw CompilerException(
-							UnexpectedErrorMsg(GetCurrCharName()),
-							m_line, m_col
-						);
+					return true;
 				};
+
+				p_param.clear();
+				for (usize i = 0; i < chars.Size(); i += desc.width)
+					p_param += static_cast<char>(Load(chars.Data() + i, desc.width));
+
+				return true;
 			};
-		};
 
-		const std::vector<Token> &GetTokens() {
-			return m_tokens;
-		};
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+			u8 GetNextParam8() {
+				u8 param;
+				if (not TryGetNextParam8(param))
+					ThrowOutOfParams();
 
-	private:
-		// Functions for shorter code
-		std::string GetCurrCharName() {
-			if (m_it == m_code->cend())
-				return "end of file";
+				return param;
+			};
 
-			switch (*m_it) {
-			case '\0': return "null terminator";
-			case '\a': return "bell code";
-			case '\b': return "backspace";
-			case '\e': return "escape";
-			case '\f': return "formfeed page break";
-			case '\n': return "new line";
-			case '\r': return "carriage return";
-			case '\t': return "tab";
-			case '\v': return "vertical tab";
+			u16 GetNextParam16() {
+				u16 param;
+				if (not TryGetNextParam16(param))
+					ThrowOutOfParams();
 
-			default: return (std::string)"character '" + *m_it + "'";
+				return param;
 			};
-		};
 
-		void Inc() {
-			++ m_it; ++ m_totalCol;
-		};
+			u32 GetNextParam32() {
+				u32 param;
+				if (not TryGetNextParam32(param))
+					ThrowOutOfParams();
 
-		void Dec() {
-			-- m_it; -- m_totalCol;
-		};
+				return param;
+			};
 
-		void LexFwdSlash() {
-			switch (*m_it) {
-			case '*':
-				Inc();
-				LexCommMul();
-				break;
+			u64 GetNextParam64() {
+				u64 param;
+				if (not TryGetNextParam64(param))
+					ThrowOutOfParams();
 
-			case '/':
-				Inc();
-				LexComm();
-				break;
+				return param;
+			};
 
-			default:
-				throw CompilerException(
-						UnexpectedErrorMsg(std::string(1, '/')),
-						m_line, m_col
-					);
+			u64 GetNextParamInt() {
+				u64 param;
+				if (not TryGetNextParamInt(param))
+					ThrowOutOfParams();
+
+				return param;
 			};
-		};
 
-		void LexStr() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch (*m_it) {
-				case '\\':
-					if (m_escape) {
-						m_token += *m_it;
-						m_escape = false;
-						break;
-					};
+			std::string GetNextParamStr() {
+				std::string param;
+				if (not TryGetNextParamStr(param))
+					ThrowOutOfParams();
 
-					m_escape = true;
-					break;
+				return param;
+			};
 
-				case '"':
-					if (m_escape) {
-						m_token += *m_it;
-						m_escape = false;
-						break;
-					};
+			void ReadArgs() {
+				if (not TryReadArgs())
+					throw Exception(Error(ErrorCode::InvalidArgTable));
+			};
 
-					m_tokens.push_back(Token(
-						TokenType::Str,
-						m_token, m_line, m_col
-					));
+			u64 GetArgInt(const usize p_idx) const {
+				u64 param;
+				if (not TryGetArgInt(p_idx, param))
+					ThrowArgError(p_idx, ArgKind::Int);
 
-					m_token = "";
+				return param;
+			};
 
-					return;
+			ParamView GetArgView(const usize p_idx) const {
+				ParamView param;
+				if (not TryGetArgView(p_idx, param))
+					ThrowArgError(p_idx, ArgKind::Str);
 
-				case '\n':
-					throw CompilerException(
-							ExpectedErrorMsg("string end", GetCurrCharName()),
-							m_line, m_col
-						);
-					break;
+				return param;
+			};
 
-				default:
-					if (m_escape) {
-						switch(*m_it) {
-						case '0': m_token += '\0'; break;
-						case 'a': m_token += '\a'; break;
-						case 'b': m_token += '\v'; break;
-						case 'e': m_token += '\e'; break;
-						case 'f': m_token += '\f'; break;
-						case 'n': m_token += '\n'; break;
-						case 'r': m_token += '\r'; break;
-						case 't': m_token += '\t'; break;
-						case 'v': m_token += '\v'; break;
-						};
+			std::string GetArgStr(const usize p_idx) const {
+				std::string param;
+				if (not TryGetArgStr(p_idx, param))
+					ThrowArgError(p_idx, ArgKind::Str);
 
-						m_escape = false;
-					} else
-						m_token += *m_it;
-				};
+				return param;
 			};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
 
-			throw CompilerException(
-					ExpectedErrorMsg("string end", GetCurrCharName()),
-					m_line, m_col
-				);
-		};
+			usize Remaining() const {
+				return m_end - m_it;
+			};
 
-		void LexId() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch (*m_it) {
-				case SCBL_NAME_CHARS:
-				case SCBL_DEC_CHARS:
-					m_token += *m_it;
-					break;
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+			template <typename T>
+			const T *GetNextSpan(const usize p_count) {
+				const T *data;
+				if (not TryGetNextSpan(data, p_count))
+					ThrowOutOfParams();
 
-				default: goto l_loopEnd;
-				};
+				return data;
 			};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
 
-		l_loopEnd: // Labels arent entirely apart of the
-		           // "forbidden C++", when used correctly
-		           // they can make code MORE readable and
-		           // better
-			m_tokens.push_back(Token(
-				TokenType::Id,
-				m_token, m_line, m_col
-			));
+			// The parameters which were not read yet
+			ParamView Rest() const {
+				return ParamView(m_it, Remaining());
+			};
 
-			m_token = "";
-			Dec();
-		};
+			bool AtEnd() const {
+				return m_it == m_end;
+			};
 
-		void LexDec() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch (*m_it) {
-				case SCBL_DEC_CHARS:
-					m_token += *m_it;
-					break;
+			void ResetCounter() {
+				m_it = m_begin;
+			};
 
-				case SCBL_NAME_CHARS:
-					throw CompilerException(
-							ExpectedErrorMsg("a dec digit", GetCurrCharName()),
-							m_line, m_col
-						);
+		private:
+			// The argument is inside of the p_size bytes of parameters, and
+			// so is the value of integers. Strings are checked when read
+			static bool IsValidArg(const ArgDesc &p_desc, const usize p_size) {
+				if (p_desc.offset > p_size or p_desc.size > p_size - p_desc.offset)
+					return false;
 
-					break;
+				switch (p_desc.kind) {
+				case ArgKind::Int: return IsLoadable(p_desc.width) and p_desc.width <= p_desc.size;
+				case ArgKind::Str:
+				case ArgKind::Bytes: return true;
 
-				default: goto l_loopEnd;
+				default: return false;
 				};
 			};
 
-		l_loopEnd:
-			m_tokens.push_back(Token(
-				TokenType::Int,
-				static_cast<u64>(std::stoull(m_token)),
-				m_line, m_col
-			));
+			static bool IsLoadable(const u8 p_width) {
+				return p_width == 1 or p_width == 2 or p_width == 4 or p_width == 8;
+			};
 
-			m_token = "";
-			Dec();
-		};
+			// The string argument which starts at p_offset. The table is
+			// in the order of the offsets, and arguments without any bytes
+			// can start at the same offset as the next one
+			bool TryFindStrArg(const usize p_offset, usize &p_idx, ArgDesc &p_desc) const {
+				usize low = 0, high = m_argCount;
+				while (low < high) {
+					const usize mid = low + (high - low) / 2;
+					TryGetArg(mid, p_desc);
+
+					if (p_desc.offset < p_offset)
+						low = mid + 1;
+					else
+						high = mid;
+				};
 
-		void LexHex() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch (*m_it) {
-				case SCBL_HEX_CHARS:
-					m_token += *m_it;
-					break;
+				for (p_idx = low; TryGetArg(p_idx, p_desc) and p_desc.offset == p_offset; ++ p_idx) {
+					if (p_desc.kind == ArgKind::Str)
+						return true;
+				};
 
-				case SCBL_NAME_CHARS_NO_HEX:
-					throw CompilerException(
-							ExpectedErrorMsg("a hex digit", GetCurrCharName()),
-							m_line, m_col
-						);
+				return false;
+			};
 
-					break;
+			// Skips the padding before a p_size wide integer in the native
+			// layout, false (without skipping) if it does not fit after it
+			bool Skip(const u8 p_size) {
+				const u8 *it = m_it;
+				if (m_layout == Layout::Native)
+					it = m_begin + AlignUp(m_it - m_begin, p_size);
 
-				default: goto l_loopEnd;
-				};
+				if (it > m_end or static_cast<usize>(m_end - it) < p_size)
+					return false;
+
+				m_it = it;
+
+				return true;
 			};
 
-		l_loopEnd:
-			m_tokens.push_back(Token(
-				TokenType::Int,
-				static_cast<u64>(std::stoull(m_token, nullptr, 16)),
-				m_line, m_col
-			));
+			// Joins the next p_size bytes
+			u64 Join(const u8 p_size) {
+				const u64 value = Load(m_it, p_size);
+				m_it += p_size;
 
-			m_token = "";
-			Dec();
-		};
+				return value;
+			};
 
-		void LexComm() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch (*m_it) {
-				case '\n':
-					++ m_line;
-					m_totalCol = 0;
-					return;
-				};
+			u64 Load(const u8 *p_bytes, const u8 p_size) const {
+				return m_layout == Layout::Native?
+					LoadNative(p_bytes, p_size) : JoinAt(p_bytes, p_size);
 			};
-		};
 
-		void LexCommMul() {
-			for (; m_it != m_code->cend(); Inc()) {
-				switch(*m_it) {
-				case '\n':
-					++ m_line;
-					m_totalCol = 0;
-					break;
+			static u64 JoinAt(const u8 *p_bytes, const u8 p_size) {
+				u64 value = 0;
+				for (u8 i = 0; i < p_size; ++ i)
+					value = (value << 010) | p_bytes[i];
 
-				case '*':
-					Inc();
+				return value;
+			};
 
-					switch (*m_it) {
-					case '/': return;
-					default: Dec();
-					};
-				};
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+			[[noreturn]] static void ThrowOutOfParams() {
+				throw Exception(Error(ErrorCode::OutOfParams));
 			};
 
-			throw CompilerException(
-					ExpectedErrorMsg(
-						"multi-line comment end", GetCurrCharName()
-					), m_line, m_col
-				);
-		};
+			// p_kind is the kind which was asked for
+			[[noreturn]] void ThrowArgError(const usize p_idx, const ArgKind p_kind) const {
+				if (p_idx >= m_argCount)
+					ThrowOutOfParams();
 
-		std::vector<Token> m_tokens;
-		std::string m_token;
+				ArgDesc desc;
+				TryGetArg(p_idx, desc);
 
-		usize m_col, m_totalCol;
-		usize m_line;
+				Error error(desc.kind == p_kind? ErrorCode::InvalidArgTable : ErrorCode::WrongParamType,
+				            ErrorSubject::Int);
+				error.num = p_idx;
 
-		const std::string *m_code;
-		std::string::const_iterator m_it;
+				throw Exception(error);
+			};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
 
-		bool m_escape;
-	}; // class Lexer
+			const u8 *m_begin, *m_it, *m_end;
 
-	enum class StructcodeType : u8 {
+			// Argument table of typed parameters, nullptr if not read
+			const u8 *m_args;
+			usize m_argCount;
+
+			Layout m_layout;
+		}; // class ParamHandler
+	}; // namespaces Tools
+
+
+	enum class TokenType : u8 {
 		Int,
-		Id
-	}; // enum class StructcodeType
+		Id,
+		Str,
+		Sym
+	}; // enum class TokenType
 
-	struct Structcode {
+	struct Token {
 	public:
-		Structcode() {};
+		Token() {};
 
-		Structcode(
-			const StructcodeType p_type,
-			const std::variant<u8, std::string> p_data
+		Token(
+			const TokenType p_type,
+			std::variant<u64, std::pmr::string, char> p_data,
+			const usize p_offset
 		):
 			type(p_type),
-			data(p_data)
+			data(std::move(p_data)),
+			offset(p_offset)
 		{};
 
-		StructcodeType type;
-		std::variant<u8, std::string> data;
-	}; // struct Structcode
+		TokenType type;
+		std::variant<u64, std::pmr::string, char> data;
 
-	class Compiler {
+		usize offset; // Byte offset in the source, see LineIndex
+	}; // class Token
+
+	// Offsets of all the new lines in a source, used to turn byte
+	// offsets into lines and columns. Only built when a position
+	// actually has to be shown
+	class LineIndex {
 	public:
-		Compiler() {};
+		LineIndex(
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			m_newlines(p_resource)
+		{};
 
-		Compiler(const std::vector<Token> &p_tokens) {
-			Compile(p_tokens);
+		LineIndex(
+			const std::string &p_code,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			m_newlines(p_resource)
+		{
+			Build(p_code);
 		};
 
-		void Compile(const std::vector<Token> &p_tokens) {
-			m_scode.clear();
+		void Build(const std::string &p_code) {
+			m_newlines.clear();
 
-			m_tokens = &p_tokens;
+			// memchr is vectorized by the C library, so this scans
+			// many bytes at once instead of going char by char
+			const char *begin = p_code.data();
+			const char *end   = begin + p_code.size();
+			for (const char *it = begin; it < end; ++ it) {
+				it = static_cast<const char*>(std::memchr(it, '\n', end - it));
+				if (it == nullptr)
+					break;
+
+				m_newlines.push_back(it - begin);
+			};
+		};
+
+		// Lines and columns start at 1
+		void Locate(const usize p_offset, usize &p_line, usize &p_col) const {
+			// Amount of new lines before the offset
+			usize low = 0, high = m_newlines.size();
+			while (low < high) {
+				const usize mid = low + (high - low) / 2;
+
+				if (m_newlines[mid] < p_offset)
+					low = mid + 1;
+				else
+					high = mid;
+			};
+
+			p_line = low + 1;
+			p_col  = low == 0? p_offset + 1 : p_offset - m_newlines[low - 1];
+		};
+
+		void Locate(Error &p_error) const {
+			Locate(p_error.offset, p_error.line, p_error.col);
+		};
+
+		usize Lines() const {
+			return m_newlines.size() + 1;
+		};
+
+		MemUsage GetMemUsage() const {
+			return {m_newlines.size(), Tools::VectorBytes(m_newlines)};
+		};
+
+	private:
+		std::pmr::vector<usize> m_newlines;
+	}; // class LineIndex
+
+	// All the classes take a memory resource which they allocate from,
+	// it has to outlive the object
+	class Lexer {
+	public:
+		Lexer(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_tokens(p_resource),
+			m_token(p_resource),
+			m_code(nullptr),
+			m_lineIndex(p_resource),
+			m_lineIndexBuilt(false)
+		{};
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		Lexer(
+			const std::string &p_code,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			Lexer(p_resource)
+		{
+			Lex(p_code);
+		};
+
+		void Lex(const std::string &p_code) {
+			Error error = TryLex(p_code);
+			if (error) {
+				Locate(error);
+				ThrowError(error);
+			};
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		// Errors only have an offset, use Locate to get their line
+		// and column
+		Error TryLex(const std::string &p_code) {
+			return TryLex(p_code, 0, p_code.size());
+		};
+
+		// Only lexes the code between the offsets, the token offsets are
+		// still from the start of the code. The part has to start outside
+		// of a multi-line comment
+		Error TryLex(const std::string &p_code, const usize p_begin, const usize p_end) {
+			m_tokens.clear();
+			m_token.clear();
+
+			m_code = &p_code;
+			m_end  = p_code.cbegin() + p_end;
+			m_lineIndexBuilt = false;
+
+			m_escape = false;
 			for (
-				m_it = p_tokens.cbegin();
-				m_it != p_tokens.cend();
+				m_it = p_code.cbegin() + p_begin;
+				m_it != m_end;
 				++ m_it
 			) {
-				switch (m_it->type) {
-				case TokenType::Str: CompStr(); break;
-				case TokenType::Int:
-					PushSplit(GetSize(4), std::get<u64>(m_it->data));
+				m_start = m_it - p_code.cbegin();
+
+				switch (*m_it) {
+				case '\n': case '\t': case '\r': case ' ':
 					break;
 
-				case TokenType::Id:
-					m_scode.push_back(Structcode(
-						StructcodeType::Id,
-						std::get<std::string>(m_it->data)
+				case ':': case '~': case '@':
+					m_tokens.push_back(Token(
+						TokenType::Sym,
+						*m_it, m_start
 					));
 
 					break;
 
+				case '#': ++ m_it; LexComm(); break;
+				case SCBL_NAME_CHARS: LexId(); break;
+
+				case '/':
+					++ m_it;
+					if (not LexFwdSlash())
+						return m_error;
+
+					break;
+
+				case '"':
+					++ m_it;
+					if (not LexStr())
+						return m_error;
+
+					break;
+
+				case '$':
+					++ m_it;
+					if (not LexHex())
+						return m_error;
+
+					break;
+
+				case SCBL_DEC_CHARS:
+					if (not LexDec())
+						return m_error;
+
+					break;
+
 				default:
-					throw CompilerException(
-							UnexpectedErrorMsg(GetCurrTokName()),
-							m_it->line, m_it->col
-						);
+					Fail(ErrorCode::UnexpectedChar);
+
+					return m_error;
 				};
 			};
+
+			return Error();
 		};
 
-		const std::vector<Structcode> &GetStructcode() {
-			return m_scode;
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		void LexParallel(const std::string &p_code, const usize p_threads = 0) {
+			Error error = TryLexParallel(p_code, p_threads);
+			if (error) {
+				Locate(error);
+				ThrowError(error);
+			};
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		static constexpr const usize ParallelMinChunk = 1 << 20;
+
+		// Lexes the code on p_threads threads (0 for all the cores), giving
+		// the same tokens and errors as TryLex. The code is split into chunks
+		// after new lines, a pre-pass finds which chunks end inside of a
+		// multi-line comment, those are joined with the next one
+		Error TryLexParallel(const std::string &p_code, usize p_threads = 0) {
+			if (p_threads == 0)
+				p_threads = std::thread::hardware_concurrency();
+
+			if (p_threads <= 1 or p_code.size() < ParallelMinChunk * 2)
+				return TryLex(p_code);
+
+			const char *data = p_code.data();
+			const usize size = p_code.size();
+
+			// A few chunks per thread, so an uneven chunk does not hold
+			// the others up
+			usize chunkSize = size / (p_threads * 4);
+			if (chunkSize < ParallelMinChunk)
+				chunkSize = ParallelMinChunk;
+
+			std::vector<usize> bounds = {0};
+			for (usize pos = chunkSize; pos < size; pos = bounds.back() + chunkSize) {
+				const char *newline = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+				if (newline == nullptr or newline + 1 == data + size)
+					break;
+
+				bounds.push_back(newline + 1 - data);
+			};
+
+			bounds.push_back(size);
+
+			const usize chunks = bounds.size() - 1;
+			std::vector<u8> endsInComment(chunks);
+			Tools::ParallelFor(p_threads, chunks, [&](const usize p_idx) {
+				endsInComment[p_idx] = Tools::EndsInComment(
+					data + bounds[p_idx], data + bounds[p_idx + 1], false
+				);
+			});
+
+			// Only the chunks starting inside of a comment have to be
+			// scanned again, which is rare
+			std::vector<usize> parts = {0};
+			bool inComment = false;
+			for (usize i = 0; i < chunks; ++ i) {
+				if (inComment)
+					inComment = Tools::EndsInComment(data + bounds[i], data + bounds[i + 1], true);
+				else
+					inComment = endsInComment[i];
+
+				if (not inComment)
+					parts.push_back(bounds[i + 1]);
+			};
+
+			// The last part ends in an unterminated comment
+			if (parts.back() != size)
+				parts.push_back(size);
+
+			// Memory resources do not have to be thread safe, so the parts
+			// are lexed with new and delete unless that is ours already
+			std::pmr::memory_resource *newDelete = std::pmr::new_delete_resource();
+			const bool sameResource = GetResource()->is_equal(*newDelete);
+
+			const usize partCount = parts.size() - 1;
+			std::vector<Lexer> lexers;
+			lexers.reserve(partCount);
+			for (usize i = 0; i < partCount; ++ i)
+				lexers.emplace_back(newDelete);
+
+			std::vector<Error> errors(partCount);
+			Tools::ParallelFor(p_threads, partCount, [&](const usize p_idx) {
+				errors[p_idx] = lexers[p_idx].TryLex(p_code, parts[p_idx], parts[p_idx + 1]);
+			});
+
+			m_tokens.clear();
+			m_token.clear();
+
+			m_code = &p_code;
+			m_end  = p_code.cend();
+			m_lineIndexBuilt = false;
+
+			usize tokenCount = 0;
+			for (const Lexer &lexer : lexers)
+				tokenCount += lexer.m_tokens.size();
+
+			m_tokens.reserve(tokenCount);
+			for (usize i = 0; i < partCount; ++ i) {
+				std::pmr::vector<Token> &tokens = lexers[i].m_tokens;
+
+				if (sameResource)
+					m_tokens.insert(
+						m_tokens.end(),
+						std::make_move_iterator(tokens.begin()),
+						std::make_move_iterator(tokens.end())
+					);
+				else {
+					for (Token &token : tokens) {
+						if (std::holds_alternative<std::pmr::string>(token.data))
+							token.data = std::pmr::string(
+								std::get<std::pmr::string>(token.data), GetResource()
+							);
+
+						m_tokens.push_back(std::move(token));
+					};
+				};
+
+				// Like TryLex, the tokens before the error are kept
+				if (errors[i]) {
+					m_error = errors[i];
+
+					return m_error;
+				};
+			};
+
+			return Error();
+		};
+
+		const std::pmr::vector<Token> &GetTokens() const {
+			return m_tokens;
+		};
+
+		std::pmr::memory_resource *GetResource() const {
+			return m_tokens.get_allocator().resource();
+		};
+
+		// Fills in the line and column of an error from its offset,
+		// the last lexed code has to still exist
+		void Locate(Error &p_error) {
+			GetLineIndex().Locate(p_error);
+		};
+
+		struct MemStats {
+		public:
+			MemUsage tokens;
+			MemUsage lineIndex;
+		}; // struct MemStats
+
+		MemStats GetMemStats() const {
+			MemStats stats;
+			stats.tokens.count = m_tokens.size();
+			stats.tokens.bytes = Tools::VectorBytes(m_tokens) + Tools::StringBytes(m_token);
+			for (const Token &token : m_tokens) {
+				if (std::holds_alternative<std::pmr::string>(token.data))
+					stats.tokens.bytes += Tools::StringBytes(std::get<std::pmr::string>(token.data));
+			};
+
+			stats.lineIndex = m_lineIndex.GetMemUsage();
+
+			return stats;
+		};
+
+		// Built the first time it is needed after each Lex
+		const LineIndex &GetLineIndex() {
+			if (not m_lineIndexBuilt) {
+				m_lineIndex.Build(*m_code);
+				m_lineIndexBuilt = true;
+			};
+
+			return m_lineIndex;
 		};
 
 	private:
 		// Functions for shorter code
-		std::string GetCurrTokName() {
-			if (m_it == m_tokens->cend())
-				return "end of file";
+		// Stores the error about the current character and returns
+		// false, so lexing functions can do return Fail(...);
+		bool Fail(const ErrorCode p_code) {
+			if (m_it == m_end)
+				m_error = Error(p_code, ErrorSubject::EndOfFile);
+			else {
+				m_error = Error(p_code, ErrorSubject::Char);
+				m_error.ch = *m_it;
+			};
 
-			switch (m_it->type) {
-			case TokenType::Int:
-				return (std::string)
-					"number " + std::to_string(std::get<u64>(m_it->data));
+			m_error.offset = m_start;
 
-			case TokenType::Str:
-				return (std::string)
-					"string '" + std::get<std::string>(m_it->data) + "'";
+			return false;
+		};
+
+		bool LexFwdSlash() {
+			if (m_it == m_end) {
+				-- m_it; // Report the slash itself
+				return Fail(ErrorCode::UnexpectedChar);
+			};
+
+			switch (*m_it) {
+			case '*':
+				++ m_it;
+				return LexCommMul();
+
+			case '/':
+				++ m_it;
+				LexComm();
+				return true;
+
+			default:
+				-- m_it;
+				return Fail(ErrorCode::UnexpectedChar);
+			};
+		};
+
+		bool LexStr() {
+			for (; m_it != m_end; ++ m_it) {
+				switch (*m_it) {
+				case '\\':
+					if (m_escape) {
+						m_token += *m_it;
+						m_escape = false;
+						break;
+					};
+
+					m_escape = true;
+					break;
+
+				case '"':
+					if (m_escape) {
+						m_token += *m_it;
+						m_escape = false;
+						break;
+					};
+
+					// Moving keeps the string in our memory resource
+					m_tokens.push_back(Token(
+						TokenType::Str,
+						std::move(m_token), m_start
+					));
+
+					m_token.clear();
+
+					return true;
+
+				case '\n':
+					return Fail(ErrorCode::ExpectedStrEnd);
+
+				default:
+					if (m_escape) {
+						switch(*m_it) {
+						case '0': m_token += '\0'; break;
+						case 'a': m_token += '\a'; break;
+						case 'b': m_token += '\v'; break;
+						case 'e': m_token += '\e'; break;
+						case 'f': m_token += '\f'; break;
+						case 'n': m_token += '\n'; break;
+						case 'r': m_token += '\r'; break;
+						case 't': m_token += '\t'; break;
+						case 'v': m_token += '\v'; break;
+						};
+
+						m_escape = false;
+					} else
+						m_token += *m_it;
+				};
+			};
+
+			return Fail(ErrorCode::ExpectedStrEnd);
+		};
+
+		void LexId() {
+			const std::string::const_iterator start = m_it;
+			for (; m_it != m_end; ++ m_it) {
+				switch (*m_it) {
+				case SCBL_NAME_CHARS:
+				case SCBL_DEC_CHARS:
+					break;
+
+				default: goto l_loopEnd;
+				};
+			};
+
+		l_loopEnd: // Labels arent entirely apart of the
+		           // "forbidden C++", when used correctly
+		           // they can make code MORE readable and
+		           // better
+			m_tokens.push_back(Token(
+				TokenType::Id,
+				std::pmr::string(start, m_it, GetResource()),
+				m_start
+			));
+
+			-- m_it;
+		};
+
+		// Integers are converted in place, 8 digits at a time while
+		// there are enough chars left
+		bool LexDec() {
+			static constexpr const u64 Max = ~static_cast<u64>(0);
+
+			const char *begin = m_code->data() + (m_it - m_code->cbegin());
+			const char *end   = m_code->data() + (m_end - m_code->cbegin());
+			const char *it    = begin;
+
+			u64  value    = 0;
+			bool overflow = false;
+			for (; end - it >= 8 and Tools::Swar::IsDec(Tools::Swar::Load(it)); it += 8) {
+				const u64 part = Tools::Swar::ParseDec(Tools::Swar::Load(it));
+				if (value > Max / 100000000 or (value == Max / 100000000 and part > Max % 100000000))
+					overflow = true;
+
+				value = value * 100000000 + part;
+			};
+
+			for (; it != end; ++ it) {
+				switch (*it) {
+				case SCBL_DEC_CHARS: {
+						const u64 digit = *it - '0';
+						if (value > Max / 10 or (value == Max / 10 and digit > Max % 10))
+							overflow = true;
+
+						value = value * 10 + digit;
+					};
+
+					break;
+
+				case SCBL_NAME_CHARS:
+					m_it += it - begin;
+
+					return Fail(ErrorCode::ExpectedDecDigit);
+
+				default: goto l_loopEnd;
+				};
+			};
+
+		l_loopEnd:
+			return PushInt(value, overflow, begin, it);
+		};
+
+		bool LexHex() {
+			const char *begin = m_code->data() + (m_it - m_code->cbegin());
+			const char *end   = m_code->data() + (m_end - m_code->cbegin());
+			const char *it    = begin;
+
+			u64  value    = 0;
+			bool overflow = false;
+			for (; end - it >= 8 and Tools::Swar::IsHex(Tools::Swar::Load(it)); it += 8) {
+				if (value >> 040)
+					overflow = true;
+
+				value = (value << 040) | Tools::Swar::ParseHex(Tools::Swar::Load(it));
+			};
+
+			for (; it != end; ++ it) {
+				u64 digit;
+				switch (*it) {
+				case SCBL_DEC_CHARS: digit = *it - '0'; break;
+
+				case 'a': case 'b': case 'c':
+				case 'd': case 'e': case 'f':
+					digit = *it - 'a' + 10;
+					break;
+
+				case 'A': case 'B': case 'C':
+				case 'D': case 'E': case 'F':
+					digit = *it - 'A' + 10;
+					break;
+
+				case SCBL_NAME_CHARS_NO_HEX:
+					m_it += it - begin;
+
+					return Fail(ErrorCode::ExpectedHexDigit);
+
+				default: goto l_loopEnd;
+				};
+
+				if (value >> 074)
+					overflow = true;
+
+				value = (value << 4) | digit;
+			};
+
+		l_loopEnd:
+			if (it == begin) {
+				m_it += it - begin;
+
+				return Fail(ErrorCode::ExpectedHexDigit);
+			};
+
+			return PushInt(value, overflow, begin, it);
+		};
+
+		bool PushInt(const u64 p_value, const bool p_overflow, const char *p_begin, const char *p_end) {
+			m_it += p_end - p_begin;
+
+			if (p_overflow) {
+				Fail(ErrorCode::IntOutOfRange);
+				m_error.subject = ErrorSubject::Text;
+				m_error.text    = std::string(p_begin, p_end);
+
+				return false;
+			};
+
+			m_tokens.push_back(Token(
+				TokenType::Int,
+				p_value,
+				m_start
+			));
+
+			-- m_it;
+
+			return true;
+		};
+
+		void LexComm() {
+			for (; m_it != m_end; ++ m_it) {
+				if (*m_it == '\n')
+					return;
+			};
+
+			// Step back so the main loop doesnt go
+			// past the end
+			-- m_it;
+		};
+
+		bool LexCommMul() {
+			for (; m_it != m_end; ++ m_it) {
+				switch(*m_it) {
+				case '*':
+					if (m_it + 1 != m_end and *(m_it + 1) == '/') {
+						++ m_it;
+
+						return true;
+					};
+				};
+			};
+
+			return Fail(ErrorCode::ExpectedCommEnd);
+		};
+
+		std::pmr::vector<Token> m_tokens;
+		std::pmr::string m_token;
+
+		usize m_start; // Offset of the current token
+
+		const std::string *m_code;
+		std::string::const_iterator m_it, m_end;
+
+		LineIndex m_lineIndex;
+		bool m_lineIndexBuilt;
+
+		bool m_escape;
+		Error m_error;
+	}; // class Lexer
+
+	enum class StructcodeType : u8 {
+		Int,
+		Id,
+		Align, // Zero bytes up to the alignment in the data, Layout::Native only
+		Arg,   // Starts an argument, the data is its ArgDesc::Tag
+		Typed, // The parameters after it are typed, the data is their layout
+		Slot   // Value bound to the slot, the data is its index in Compiler::GetSlots
+	}; // enum class StructcodeType
+
+	struct Structcode {
+	public:
+		Structcode() {};
+
+		Structcode(
+			const StructcodeType p_type,
+			std::variant<u8, std::pmr::string> p_data
+		):
+			type(p_type),
+			data(std::move(p_data))
+		{};
+
+		StructcodeType type;
+		std::variant<u8, std::pmr::string> data;
+	}; // struct Structcode
+
+	// Side table from structcode indexes to the source position of the
+	// token they were compiled from, only used when reporting errors
+	class SourceMap {
+	public:
+		SourceMap(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_entries(p_resource)
+		{};
+
+		void Clear() {
+			m_entries.clear();
+		};
+
+		// Entries have to be added in order of their index
+		void Add(const usize p_idx, const usize p_offset) {
+			m_entries.push_back({
+				static_cast<u32>(p_idx),
+				static_cast<u32>(p_offset)
+			});
+		};
+
+		bool Find(const usize p_idx, usize &p_offset) const {
+			// Last entry starting at or before p_idx
+			usize low = 0, high = m_entries.size();
+			while (low < high) {
+				const usize mid = low + (high - low) / 2;
+
+				if (m_entries[mid].idx <= p_idx)
+					low = mid + 1;
+				else
+					high = mid;
+			};
+
+			if (low == 0)
+				return false;
+
+			p_offset = m_entries[low - 1].offset;
+
+			return true;
+		};
+
+		// Fills in the source offset of a runtime error, the line and
+		// column come from LineIndex::Locate (or Lexer::Locate)
+		bool Locate(Error &p_error) const {
+			return Find(p_error.idx, p_error.offset);
+		};
+
+		usize Size() const {
+			return m_entries.size();
+		};
+
+		MemUsage GetMemUsage() const {
+			return {m_entries.size(), Tools::VectorBytes(m_entries)};
+		};
+
+	private:
+		struct Entry {
+			u32 idx, offset;
+		}; // struct Entry
+
+		std::pmr::vector<Entry> m_entries;
+	}; // class SourceMap
+
+	class Compiler {
+	public:
+		Compiler(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_scode(p_resource),
+			m_sourceMap(p_resource),
+			m_slots(p_resource),
+			m_version(0),
+			m_layout(Layout::BigEndian),
+			m_typed(false)
+		{};
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		Compiler(
+			const std::pmr::vector<Token> &p_tokens,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			Compiler(p_resource)
+		{
+			Compile(p_tokens);
+		};
+
+		void Compile(const std::pmr::vector<Token> &p_tokens) {
+			const Error error = TryCompile(p_tokens);
+			if (error)
+				ThrowError(error);
+		};
+
+		// Same as Compile(p_lexer.GetTokens()), but errors get
+		// their line and column from the lexer
+		void Compile(Lexer &p_lexer) {
+			const Error error = TryCompile(p_lexer);
+			if (error)
+				ThrowError(error);
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		Error TryCompile(Lexer &p_lexer) {
+			Error error = TryCompile(p_lexer.GetTokens());
+			if (error)
+				p_lexer.Locate(error);
+
+			return error;
+		};
+
+		// Errors only have an offset, use LineIndex::Locate
+		// to get their line and column
+		Error TryCompile(const std::pmr::vector<Token> &p_tokens) {
+			m_scode.clear();
+			m_sourceMap.Clear();
+			m_slots.clear();
+			m_version = NextVersion();
+
+			if (m_typed)
+				m_scode.push_back(Structcode(StructcodeType::Typed, static_cast<u8>(m_layout)));
+
+			m_tokens = &p_tokens;
+			for (
+				m_it = p_tokens.cbegin();
+				m_it != p_tokens.cend();
+				++ m_it
+			) {
+				m_sourceMap.Add(m_scode.size(), m_it->offset);
+
+				switch (m_it->type) {
+				case TokenType::Str:
+					if (not CompStr())
+						return m_error;
+
+					break;
+
+				case TokenType::Int: {
+						const auto token = m_it;
+						const u64  value = std::get<u64>(m_it->data);
+
+						u8 size = 4;
+						if (not GetSize(4, size))
+							return m_error;
+
+						// The value would be cut off
+						if (size < 8 and value >> (size * 010) != 0) {
+							m_it = token;
+							Fail(ErrorCode::IntTooBigForSize);
+							m_error.ch = size;
+
+							return m_error;
+						};
+
+						PushAlign(size);
+						PushArg(ArgKind::Int, size);
+						PushSplit(size, value);
+					};
+
+					break;
+
+				case TokenType::Id:
+					m_scode.push_back(Structcode(
+						StructcodeType::Id,
+						std::pmr::string(std::get<std::pmr::string>(m_it->data), GetResource())
+					));
+
+					break;
+
+				case TokenType::Sym:
+					if (not IsSym('@')) {
+						Fail(ErrorCode::UnexpectedToken);
+
+						return m_error;
+					};
+
+					if (not CompSlot())
+						return m_error;
+
+					break;
+
+				default:
+					Fail(ErrorCode::UnexpectedToken);
+
+					return m_error;
+				};
+			};
+
+			return Error();
+		};
+
+		const std::pmr::vector<Structcode> &GetStructcode() {
+			return m_scode;
+		};
+
+		const std::pmr::vector<Structcode> &GetStructcode() const {
+			return m_scode;
+		};
+
+		// Names of the slots (@name, or @1 for the name "1") in the last
+		// compiled code, by their index. See Bindings
+		const std::pmr::vector<std::pmr::string> &GetSlots() const {
+			return m_slots;
+		};
+
+		// Maps structcode indexes of the last compiled code
+		// back to the source
+		const SourceMap &GetSourceMap() const {
+			return m_sourceMap;
+		};
+
+		// Layout of the integers in the code compiled after this,
+		// functions have to read their parameters with the same one
+		void SetLayout(const Layout p_layout) {
+			m_layout = p_layout;
+		};
+
+		Layout GetLayout() const {
+			return m_layout;
+		};
+
+		// Typed code records the kind and size of every argument and
+		// passes strings with their length instead of a null terminator.
+		// The environment appends a table of the arguments to the
+		// parameters, read with ParamHandler::TryReadArgs
+		void SetTyped(const bool p_typed) {
+			m_typed = p_typed;
+		};
+
+		bool IsTyped() const {
+			return m_typed;
+		};
+
+		// Different for every compilation of every compiler, 0 if
+		// nothing was compiled yet. Environment::Run(Compiler) keys
+		// its parameter cache on it
+		u64 GetVersion() const {
+			return m_version;
+		};
+
+		std::pmr::memory_resource *GetResource() const {
+			return m_scode.get_allocator().resource();
+		};
+
+		struct MemStats {
+		public:
+			MemUsage structcode;
+			MemUsage sourceMap;
+		}; // struct MemStats
+
+		MemStats GetMemStats() const {
+			MemStats stats;
+			stats.structcode.count = m_scode.size();
+			stats.structcode.bytes = Tools::VectorBytes(m_scode);
+			for (const Structcode &scode : m_scode) {
+				if (scode.type == StructcodeType::Id)
+					stats.structcode.bytes += Tools::StringBytes(std::get<std::pmr::string>(scode.data));
+			};
+
+			stats.structcode.bytes += Tools::VectorBytes(m_slots);
+			for (const std::pmr::string &slot : m_slots)
+				stats.structcode.bytes += Tools::StringBytes(slot);
+
+			stats.sourceMap = m_sourceMap.GetMemUsage();
+
+			return stats;
+		};
+
+	private:
+		static u64 NextVersion() {
+			static std::atomic<u64> version(0);
+
+			return ++ version;
+		};
+
+		// Functions for shorter code
+		// Stores the error about the current token and returns false
+		bool Fail(const ErrorCode p_code) {
+			if (m_it == m_tokens->cend()) {
+				m_error = Error(p_code, ErrorSubject::EndOfFile);
+
+				// Report it at the last token
+				m_error.offset = (m_it - 1)->offset;
+
+				return false;
+			};
+
+			switch (m_it->type) {
+			case TokenType::Int:
+				m_error = Error(p_code, ErrorSubject::Int);
+				m_error.num = std::get<u64>(m_it->data);
+				break;
+
+			case TokenType::Str:
+				m_error = Error(p_code, ErrorSubject::Str, std::get<std::pmr::string>(m_it->data));
+				break;
+
+			case TokenType::Id:
+				m_error = Error(p_code, ErrorSubject::Id, std::get<std::pmr::string>(m_it->data));
+				break;
+
+			case TokenType::Sym:
+				m_error = Error(p_code, ErrorSubject::Sym);
+				m_error.ch = std::get<char>(m_it->data);
+				break;
+			};
+
+			m_error.offset = m_it->offset;
+
+			return false;
+		};
+
+		bool CompStr() {
+			const std::pmr::string &value = std::get<std::pmr::string>(m_it->data);
+			bool strEndWithNull = true;
+
+			++ m_it;
+			if (IsSym('~'))
+				strEndWithNull = false;
+			else
+				-- m_it;
+
+			u8 size = 1;
+			if (not GetSize(1, size))
+				return false;
+
+			if (m_typed) {
+				PushAlign(4);
+				PushArg(ArgKind::Str, size);
+				PushSplit(4, value.size());
+			};
+
+			PushAlign(size);
+			for (const char ch : value)
+				PushSplit(size, static_cast<u64>(ch));
+
+			if (strEndWithNull and not m_typed)
+				PushSplit(size, 0);
+
+			return true;
+		};
+
+		// Slots with the same name share their index
+		bool CompSlot() {
+			const usize at = m_it->offset;
+
+			++ m_it;
+			if (m_it == m_tokens->cend() or m_it->offset != at + 1)
+				return Fail(ErrorCode::ExpectedSlotName);
+
+			std::pmr::string name(GetResource());
+			switch (m_it->type) {
+			case TokenType::Id:  name = std::get<std::pmr::string>(m_it->data); break;
+			case TokenType::Int: {
+					const std::string num = std::to_string(std::get<u64>(m_it->data));
+					name.assign(num.data(), num.size());
+				};
+
+				break;
+
+			default: return Fail(ErrorCode::ExpectedSlotName);
+			};
+
+			usize idx = 0;
+			while (idx < m_slots.size() and m_slots[idx] != name)
+				++ idx;
+
+			if (idx == m_slots.size()) {
+				if (idx == MaxSlots)
+					return Fail(ErrorCode::TooManySlots);
+
+				m_slots.push_back(std::move(name));
+			};
+
+			m_scode.push_back(Structcode(StructcodeType::Slot, static_cast<u8>(idx)));
+
+			return true;
+		};
+
+		// Pushes the number as p_size bytes in the layout
+		void PushSplit(const u8 p_size, const u64 p_num) {
+			if (m_layout == Layout::Native) {
+				u8 bytes[8];
+				Tools::StoreNative(p_num, p_size, bytes);
+
+				for (u8 i = 0; i < p_size; ++ i)
+					m_scode.push_back(Structcode(StructcodeType::Int, bytes[i]));
+
+				return;
+			};
+
+			for (u8 i = p_size; i > 0; -- i)
+				m_scode.push_back(Structcode(
+					StructcodeType::Int,
+					static_cast<u8>(p_num >> ((i - 1) * 010))
+				));
+		};
+
+		// Lets the environment pad the parameters before a p_size
+		// wide integer in the native layout
+		void PushAlign(const u8 p_size) {
+			if (m_layout == Layout::Native and p_size > 1)
+				m_scode.push_back(Structcode(StructcodeType::Align, p_size));
+		};
+
+		void PushArg(const ArgKind p_kind, const u8 p_width) {
+			if (m_typed)
+				m_scode.push_back(Structcode(StructcodeType::Arg, ArgDesc::Tag(p_kind, p_width)));
+		};
+
+		bool GetSize(const u8 p_default, u8 &p_size) {
+			++ m_it;
+			if (IsSym(':')) {
+				++ m_it;
+
+				if (m_it != m_tokens->cend() and m_it->type == TokenType::Int) {
+					const u64 value = std::get<u64>(m_it->data);
+					switch (value) {
+					case 1: case 2:
+					case 4: case 8:
+						p_size = value;
+						return true;
+
+					default: return Fail(ErrorCode::InvalidSize);
+					};
+				};
+
+				return Fail(ErrorCode::ExpectedSize);
+			} else {
+				-- m_it;
+				p_size = p_default;
+
+				return true;
+			};
+		};
+
+		bool IsSym(const char p_sym) {
+			if (m_it == m_tokens->cend())
+				return false;
+
+			switch (m_it->type) {
+			case TokenType::Sym:
+				return std::get<char>(m_it->data) == p_sym;
+
+			default: return false;
+			};
+		};
+
+		// Slot indexes are stored in a byte
+		static constexpr const usize MaxSlots = 256;
+
+		std::pmr::vector<Structcode> m_scode;
+		SourceMap m_sourceMap;
+		std::pmr::vector<std::pmr::string> m_slots;
+
+		u64 m_version;
+		Layout m_layout;
+		bool m_typed;
+
+		const std::pmr::vector<Token> *m_tokens;
+		std::pmr::vector<Token>::const_iterator m_it;
+
+		Error m_error;
+	}; // class Compiler
+
+	struct Func {
+	public:
+		// staticIdx of the functions which are not of a StaticEnvironment
+		static constexpr const u32 Dynamic = 0xFFFFFFFF;
+
+		Func():
+			batchConsts(false),
+			pure(false),
+			staticIdx(Dynamic),
+			slot(0)
+		{};
+
+		Func(const Callback &p_callback):
+			callback(p_callback),
+			batchConsts(false),
+			pure(false),
+			staticIdx(Dynamic),
+			slot(0)
+		{};
+
+		Func(const SegmentCallback &p_callback):
+			segmentCallback(p_callback),
+			batchConsts(false),
+			pure(false),
+			staticIdx(Dynamic),
+			slot(0)
+		{};
+
+		Func(const BatchCallback &p_callback, const bool p_batchConsts = false):
+			batchCallback(p_callback),
+			batchConsts(p_batchConsts),
+			pure(false),
+			staticIdx(Dynamic),
+			slot(0)
+		{};
+
+		// The result of the callback only depends on its parameters, so
+		// the environment calls it once for the same parameters and sets
+		// the constants it set again after that, see Environment::SetMemoCapacity.
+		// Only the callback is memoized, not a segment or batch one
+		static Func Pure(const Callback &p_callback) {
+			Func func(p_callback);
+			func.pure = true;
+
+			return func;
+		};
+
+		Callback callback;
+
+		// Called instead of callback if set
+		SegmentCallback segmentCallback;
+
+		// Called once for a run of consecutive calls instead of callback
+		// if set. The parameters of every call in the batch are assembled
+		// before it is called, so a call which uses a constant starts a
+		// new batch, in case the callback sets the constant
+		BatchCallback batchCallback;
+
+		// The batch callback does not set constants, so calls which use
+		// them can join a batch too
+		bool batchConsts;
+
+		// Calls are memoized, only for callback
+		bool pure;
+
+		// Index of the function in the StaticEnvironment which added it,
+		// called by it instead of the callbacks. Only works in that kind
+		// of environment, SetFuncs of a plain one leaves these out
+		u32 staticIdx;
+
+		// Index of the function name in Environment::GetFuncNames,
+		// set by the environment
+		u32 slot;
+	}; // struct Func
+
+	// Immutable bytes which constants can share instead of having their
+	// own copy, see Const::FromFile
+	class Blob {
+	public:
+		virtual ~Blob() {};
+
+		const u8 *Data() const noexcept {
+			return m_data;
+		};
+
+		usize Size() const noexcept {
+			return m_size;
+		};
+
+		ParamView View() const noexcept {
+			return ParamView(m_data, m_size);
+		};
+
+	protected:
+		Blob():
+			m_data(nullptr),
+			m_size(0)
+		{};
+
+		const u8 *m_data;
+		usize m_size;
+	}; // class Blob
+
+	class VectorBlob: public Blob {
+	public:
+		VectorBlob(std::vector<u8> &&p_bytes):
+			m_bytes(std::move(p_bytes))
+		{
+			m_data = m_bytes.data();
+			m_size = m_bytes.size();
+		};
+
+	private:
+		std::vector<u8> m_bytes;
+	}; // class VectorBlob
+
+#ifdef SCBL_HAS_MMAP
+	// Read-only mapping of a whole file
+	class MappedBlob: public Blob {
+	public:
+		// nullptr if the file could not be mapped
+		static std::shared_ptr<MappedBlob> Open(const std::string &p_path) {
+			const int fd = open(p_path.c_str(), O_RDONLY);
+			if (fd < 0)
+				return nullptr;
+
+			std::shared_ptr<MappedBlob> blob;
+
+			struct stat info;
+			if (fstat(fd, &info) == 0 and S_ISREG(info.st_mode) and info.st_size > 0) {
+				void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED)
+					blob = std::shared_ptr<MappedBlob>(new MappedBlob(data, info.st_size));
+			};
+
+			close(fd); // The mapping stays
+			return blob;
+		};
+
+		~MappedBlob() override {
+			munmap(const_cast<u8*>(m_data), m_size);
+		};
+
+	private:
+		MappedBlob(void *p_data, const usize p_size) {
+			m_data = static_cast<const u8*>(p_data);
+			m_size = p_size;
+		};
+	}; // class MappedBlob
+#endif // SCBL_HAS_MMAP
+
+	struct Const {
+	public:
+		// Allocator aware, so maps using a memory resource
+		// keep the value in it too
+		using allocator_type = std::pmr::polymorphic_allocator<u8>;
+
+		// Makes the value of a lazy constant, gets the user data of the
+		// environment
+		using Producer = std::function<Const(void*)>;
+
+		static constexpr const u8 Size8b  = 1;
+		static constexpr const u8 Size16b = 2;
+		static constexpr const u8 Size32b = 4;
+		static constexpr const u8 Size64b = 8;
+
+		static bool IsValidSize(const u8 p_size) {
+			switch (p_size) {
+			case Size8b:  case Size16b:
+			case Size32b: case Size64b:
+				return true;
+
+			default: return false;
+			};
+		};
+
+		Const() {};
+
+		explicit Const(const allocator_type &p_alloc):
+			value(p_alloc)
+		{};
+
+		Const(
+			const u64 p_num,
+			const u8 p_size = Size32b,
+			const allocator_type &p_alloc = {}
+		):
+			value(p_alloc),
+			kind(ArgKind::Int),
+			width(p_size)
+		{
+			Split(p_num, p_size);
+		};
+
+		Const(
+			const std::string &p_str,
+			const u8 p_size = Size8b,
+			const allocator_type &p_alloc = {}
+		):
+			value(p_alloc),
+			kind(ArgKind::Str),
+			width(p_size)
+		{
+			value.reserve(p_str.size() * p_size + 1);
+			for (const char ch : p_str)
+				Split(ch, p_size);
+
+			value.push_back(0); // Null terminator
+		};
+
+		Const(const std::vector<u8> &p_list, const allocator_type &p_alloc = {}):
+			value(p_list.begin(), p_list.end(), p_alloc)
+		{};
+
+		Const(const ParamView p_list, const allocator_type &p_alloc = {}):
+			value(p_list.begin(), p_list.end(), p_alloc)
+		{};
+
+		// Shares the bytes of p_blob, copying the constant
+		// only copies the pointer
+		Const(std::shared_ptr<const Blob> p_blob, const allocator_type &p_alloc = {}):
+			value(p_alloc),
+			blob(std::move(p_blob))
+		{};
+
+		Const(const Const &p_const) = default;
+		Const(Const &&p_const) = default;
+
+		Const(const Const &p_const, const allocator_type &p_alloc):
+			value(p_const.value, p_alloc),
+			blob(p_const.blob),
+			kind(p_const.kind),
+			width(p_const.width),
+			align(p_const.align),
+			producer(p_const.producer),
+			perRun(p_const.perRun),
+			producedRun(p_const.producedRun),
+			producedCall(p_const.producedCall),
+			version(p_const.version)
+		{};
+
+		Const(Const &&p_const, const allocator_type &p_alloc):
+			value(std::move(p_const.value), p_alloc),
+			blob(std::move(p_const.blob)),
+			kind(p_const.kind),
+			width(p_const.width),
+			align(p_const.align),
+			producer(std::move(p_const.producer)),
+			perRun(p_const.perRun),
+			producedRun(p_const.producedRun),
+			producedCall(p_const.producedCall),
+			version(p_const.version)
+		{};
+
+		// The number in the byte order of the machine, aligned to its
+		// size in the parameters. For code compiled with Layout::Native
+		static Const Native(
+			const u64 p_num,
+			const u8 p_size = Size32b,
+			const allocator_type &p_alloc = {}
+		) {
+			Const constant(p_alloc);
+			if (not IsValidSize(p_size)) {
+				constant.Split(p_num, p_size); // Reports the error
+
+				return constant;
+			};
+
+			constant.value.resize(p_size);
+			Tools::StoreNative(p_num, p_size, constant.value.data());
+			constant.kind  = ArgKind::Int;
+			constant.width = p_size;
+			constant.align = p_size;
+
+			return constant;
+		};
+
+		// The integers as they are in memory, aligned to their size,
+		// so they can be read with ParamHandler::TryGetNextSpan
+		template <typename T>
+		static Const NativeList(const std::vector<T> &p_list, const allocator_type &p_alloc = {}) {
+			static_assert(
+				std::is_integral<T>::value and sizeof(T) <= 8,
+				"Lists are of integers up to 8 bytes"
+			);
+
+			Const constant(p_alloc);
+			constant.value.resize(p_list.size() * sizeof(T));
+			if (not p_list.empty())
+				std::memcpy(constant.value.data(), p_list.data(), constant.value.size());
+
+			constant.width = sizeof(T);
+			constant.align = sizeof(T);
+
+			return constant;
+		};
+
+		// The value is made by p_producer when a call uses the constant,
+		// instead of being set ahead. With p_perRun it is only made once
+		// in a run, otherwise once for every call using it. Only for
+		// constants of the environment, not for the values of slots
+		static Const Lazy(
+			const Producer &p_producer,
+			const bool p_perRun = false,
+			const allocator_type &p_alloc = {}
+		) {
+			Const constant(p_alloc);
+			constant.producer = p_producer;
+			constant.perRun   = p_perRun;
+
+			return constant;
+		};
+
+		Const &operator=(const Const &p_const) = default;
+		Const &operator=(Const &&p_const) = default;
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		static Const FromFile(const std::string &p_path) {
+			Const constant;
+			const Error error = TryFromFile(p_path, constant);
+			if (error)
+				ThrowError(error);
+
+			return constant;
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		// The contents of the file, without a null terminator. The file
+		// is mapped into memory where possible, otherwise read
+		static Error TryFromFile(const std::string &p_path, Const &p_const) {
+#ifdef SCBL_HAS_MMAP
+			std::shared_ptr<const Blob> mapped = MappedBlob::Open(p_path);
+			if (mapped != nullptr) {
+				p_const = Const(std::move(mapped));
+
+				return Error();
+			};
+#endif // SCBL_HAS_MMAP
+
+			// Empty files can not be mapped
+			std::ifstream file(p_path, std::ios::binary);
+			if (not file.is_open())
+				return Error(ErrorCode::CantReadFile, ErrorSubject::Text, p_path);
+
+			std::vector<u8> bytes(
+				(std::istreambuf_iterator<char>(file)),
+				std::istreambuf_iterator<char>()
+			);
+
+			if (file.bad())
+				return Error(ErrorCode::CantReadFile, ErrorSubject::Text, p_path);
+
+			p_const = Const(std::make_shared<const VectorBlob>(std::move(bytes)));
+
+			return Error();
+		};
+
+		// The bytes of the constant, from the blob if it has one
+		ParamView Bytes() const noexcept {
+			return blob != nullptr? blob->View() : ParamView(value);
+		};
+
+		usize Size() const noexcept {
+			return blob != nullptr? blob->Size() : value.size();
+		};
+
+	private:
+		// Appends the number as p_size big endian bytes
+		void Split(const u64 p_value, const u8 p_size) {
+			if (not IsValidSize(p_size)) {
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+				Error error(ErrorCode::InvalidConstSize, ErrorSubject::Int);
+				error.num = p_size;
+
+				throw Exception(error);
+#else // SCBL_DONT_USE_EXCEPTIONS
+				// Nothing to report the error with, check the
+				// size with IsValidSize beforehand
+				return;
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+			};
+
+			for (u8 i = p_size; i > 0; -- i)
+				value.push_back(static_cast<u8>(p_value >> ((i - 1) * 010)));
+		};
+
+	public:
+		std::pmr::vector<u8> value;
+		std::shared_ptr<const Blob> blob; // Used instead of value if set
+
+		// Passed in the argument table of typed code. Strings are passed
+		// without their null terminator there, with their length before
+		ArgKind kind = ArgKind::Bytes;
+		u8 width = 1;
+
+		// The value is padded to a multiple of this from the start of
+		// the parameters, 1 for no padding
+		u8 align = 1;
+
+		Producer producer; // Set for lazy constants
+		bool     perRun = false;
+
+		// Set by the environment, the run and call the value
+		// of a lazy constant was made for
+		u64   producedRun  = 0;
+		usize producedCall = 0;
+
+		// Set by the environment, changes every time the
+		// constant is set (or a lazy one gets a new value)
+		u64 version = 0;
+	}; // struct Const
+
+	// Values of the slots of compiled code (see Compiler::GetSlots), so the
+	// same code can be run with different values without being lexed and
+	// compiled again. Passed to Environment::Run with the code
+	class Bindings {
+	public:
+		Bindings(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_names(p_resource),
+			m_values(p_resource)
+		{};
+
+		explicit Bindings(
+			const Compiler &p_compiler,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			Bindings(p_resource)
+		{
+			SetSlots(p_compiler);
+		};
+
+		// Takes the slots of the code p_compiler compiled last, none bound
+		void SetSlots(const Compiler &p_compiler) {
+			m_names.assign(p_compiler.GetSlots().begin(), p_compiler.GetSlots().end());
+			m_values.clear();
+			m_values.resize(m_names.size());
+		};
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		void Bind(const std::string &p_name, const Const &p_value) {
+			const Error error = TryBind(p_name, p_value);
+			if (error)
+				ThrowError(error);
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		// Numbers and strings are bound as constants, Const(5, 2) or
+		// Const(std::string("text")) for example
+		Error TryBind(const std::string &p_name, const Const &p_value) {
+			for (usize i = 0; i < m_names.size(); ++ i) {
+				if (std::string_view(m_names[i]) == p_name) {
+					Bind(i, p_value);
+
+					return Error();
+				};
+			};
+
+			return Error(ErrorCode::NoSuchSlot, ErrorSubject::Text, p_name);
+		};
+
+		// By the index of the slot, without looking up its name
+		void Bind(const usize p_idx, const Const &p_value) {
+			m_values[p_idx] = p_value;
+			m_values[p_idx].version = NextVersion();
+		};
+
+		void Unbind(const usize p_idx) {
+			m_values[p_idx] = Const();
+		};
+
+		usize GetCount() const {
+			return m_names.size();
+		};
+
+		const std::pmr::string &GetName(const usize p_idx) const {
+			return m_names[p_idx];
+		};
+
+		// nullptr if the slot does not exist or is not bound
+		const Const *Get(const usize p_idx) const {
+			if (p_idx >= m_values.size() or m_values[p_idx].version == 0)
+				return nullptr;
+
+			return &m_values[p_idx];
+		};
+
+	private:
+		// Different for every value bound, so the parameter cache can
+		// tell the values of different bindings apart
+		static u64 NextVersion() {
+			static std::atomic<u64> version(0);
+
+			return ++ version;
+		};
+
+		std::pmr::vector<std::pmr::string> m_names;
+		std::pmr::vector<Const> m_values; // The version is 0 if not bound
+	}; // class Bindings
+
+	// One function call recorded by the trace
+	struct TraceEvent {
+	public:
+		u64 start;    // Timestamp of the call
+		u32 duration; // Ticks the call took, saturated
+		u32 idx;      // Structcode index of the call
+		u32 func;     // Slot of the function
+		u32 params;   // Size of the parameters in bytes
+	}; // struct TraceEvent
+
+	// Ring buffer of the last function calls. Only the environment writes
+	// to it, it can be read while the environment runs: every slot is a
+	// seqlock, events which are overwritten while being read are left out
+	class TraceBuffer {
+	public:
+		// File format, all integers are little endian:
+		//   magic "SCBLTRC1", u32 clock, u64 recorded events,
+		//   u32 name count, names (u32 length, chars),
+		//   u32 event count, events (u64 start, u32 duration,
+		//   u32 idx, u32 func, u32 params) from the oldest
+		static constexpr const char *Magic = "SCBLTRC1";
+
+		static constexpr const u32 ClockSteady = 0; // Nanoseconds
+		static constexpr const u32 ClockTSC    = 1; // CPU cycles
+
+#ifdef SCBL_TRACE_USE_TSC
+		static constexpr const u32 Clock = ClockTSC;
+#else // not SCBL_TRACE_USE_TSC
+		static constexpr const u32 Clock = ClockSteady;
+#endif // SCBL_TRACE_USE_TSC
+
+		static u64 Now() {
+#ifdef SCBL_TRACE_USE_TSC
+			return __rdtsc();
+#else // not SCBL_TRACE_USE_TSC
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()
+			).count();
+#endif // SCBL_TRACE_USE_TSC
+		};
+
+		// The capacity is rounded up to a power of 2
+		TraceBuffer(const usize p_capacity):
+			m_head(0),
+			m_begin(0)
+		{
+			usize capacity = 1;
+			while (capacity < p_capacity)
+				capacity <<= 1;
+
+			m_slots = std::make_unique<Slot[]>(capacity);
+			m_capacity = capacity;
+			m_mask     = capacity - 1;
+		};
+
+		void Record(const TraceEvent &p_event) {
+			const u64 head = m_head.load(std::memory_order_relaxed);
+			Slot &slot = m_slots[head & m_mask];
+
+			// Odd while the event is being written
+			slot.seq.store(head * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			slot.words[0].store(p_event.start, std::memory_order_relaxed);
+			slot.words[1].store(p_event.duration | static_cast<u64>(p_event.idx) << 040,
+			                    std::memory_order_relaxed);
+			slot.words[2].store(p_event.func | static_cast<u64>(p_event.params) << 040,
+			                    std::memory_order_relaxed);
+
+			slot.seq.store(head * 2 + 2, std::memory_order_release);
+			m_head.store(head + 1, std::memory_order_release);
+		};
+
+		// The head keeps counting so the sequences of the slots written
+		// before are never mistaken for new events
+		void Clear() {
+			m_begin.store(m_head.load(std::memory_order_acquire), std::memory_order_release);
+		};
+
+		usize Capacity() const {
+			return m_capacity;
+		};
+
+		// Amount of events recorded since the last Clear, including
+		// the overwritten ones
+		u64 Recorded() const {
+			return m_head.load(std::memory_order_acquire) - m_begin.load(std::memory_order_acquire);
+		};
+
+		// The events still in the buffer, from the oldest
+		std::vector<TraceEvent> GetEvents() const {
+			const u64 begin = m_begin.load(std::memory_order_acquire);
+			const u64 head  = m_head.load(std::memory_order_acquire);
+			const u64 count = head - begin < m_capacity? head - begin : m_capacity;
+
+			std::vector<TraceEvent> events;
+			events.reserve(count);
+			for (u64 i = head - count; i < head; ++ i) {
+				TraceEvent event;
+				if (TryLoad(i, event))
+					events.push_back(event);
+			};
+
+			return events;
+		};
+
+		bool Dump(std::ostream &p_stream, const std::pmr::vector<std::pmr::string> &p_names) const {
+			const std::vector<TraceEvent> events = GetEvents();
+
+			p_stream.write(Magic, 8);
+			Write(p_stream, Clock, 4);
+			Write(p_stream, Recorded(), 8);
+
+			Write(p_stream, p_names.size(), 4);
+			for (const std::pmr::string &name : p_names) {
+				Write(p_stream, name.size(), 4);
+				p_stream.write(name.data(), name.size());
+			};
+
+			Write(p_stream, events.size(), 4);
+			for (const TraceEvent &event : events) {
+				Write(p_stream, event.start,    8);
+				Write(p_stream, event.duration, 4);
+				Write(p_stream, event.idx,      4);
+				Write(p_stream, event.func,     4);
+				Write(p_stream, event.params,   4);
+			};
+
+			return p_stream.good();
+		};
+
+	private:
+		static void Write(std::ostream &p_stream, const u64 p_value, const u8 p_size) {
+			char bytes[8];
+			for (u8 i = 0; i < p_size; ++ i)
+				bytes[i] = static_cast<char>(p_value >> (i * 010));
+
+			p_stream.write(bytes, p_size);
+		};
+
+		// False if the event was overwritten before or while reading it
+		bool TryLoad(const u64 p_idx, TraceEvent &p_event) const {
+			const Slot &slot = m_slots[p_idx & m_mask];
+			const u64  seq   = p_idx * 2 + 2;
+
+			if (slot.seq.load(std::memory_order_acquire) != seq)
+				return false;
+
+			const u64 words[3] = {
+				slot.words[0].load(std::memory_order_relaxed),
+				slot.words[1].load(std::memory_order_relaxed),
+				slot.words[2].load(std::memory_order_relaxed)
+			};
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (slot.seq.load(std::memory_order_relaxed) != seq)
+				return false;
+
+			p_event.start    = words[0];
+			p_event.duration = static_cast<u32>(words[1]);
+			p_event.idx      = static_cast<u32>(words[1] >> 040);
+			p_event.func     = static_cast<u32>(words[2]);
+			p_event.params   = static_cast<u32>(words[2] >> 040);
+			return true;
+		};
+
+		// The event is kept in atomic words so reading it while it is
+		// written is not a data race, the sequence tells if it was torn
+		struct Slot {
+			std::atomic<u64> seq{0};
+			std::atomic<u64> words[3]{};
+		};
+
+		std::unique_ptr<Slot[]> m_slots;
+		usize m_capacity;
+		u64   m_mask;
+
+		std::atomic<u64> m_head, m_begin;
+	}; // class TraceBuffer
+
+	// A part of the output, written out by a sink
+	struct OutputSegment {
+	public:
+		const char *data;
+		usize size;
+	}; // struct OutputSegment
+
+	// Backend of Output, gets all the buffered output at once
+	class OutputSink {
+	public:
+		virtual ~OutputSink() {};
+
+		// Writes the segments in order
+		virtual void Write(const OutputSegment *p_segments, const usize p_count) = 0;
+	}; // class OutputSink
+
+	// Discards the output
+	class NullSink: public OutputSink {
+	public:
+		void Write(const OutputSegment*, const usize) override {};
+	}; // class NullSink
+
+	// Collects the output in memory
+	class MemorySink: public OutputSink {
+	public:
+		void Write(const OutputSegment *p_segments, const usize p_count) override {
+			for (usize i = 0; i < p_count; ++ i)
+				m_data.append(p_segments[i].data, p_segments[i].size);
+		};
+
+		const std::string &GetData() const {
+			return m_data;
+		};
+
+		void Clear() {
+			m_data.clear();
+		};
+
+	private:
+		std::string m_data;
+	}; // class MemorySink
+
+	class StreamSink: public OutputSink {
+	public:
+		StreamSink(std::ostream &p_stream):
+			m_stream(&p_stream)
+		{};
+
+		void Write(const OutputSegment *p_segments, const usize p_count) override {
+			for (usize i = 0; i < p_count; ++ i)
+				m_stream->write(p_segments[i].data, p_segments[i].size);
+
+			m_stream->flush();
+		};
+
+	private:
+		std::ostream *m_stream;
+	}; // class StreamSink
+
+#ifdef SCBL_HAS_WRITEV
+	// Writes into a file descriptor, up to BatchSize segments with one
+	// writev call unless it writes only a part of them
+	class FdSink: public OutputSink {
+	public:
+		FdSink(const int p_fd = STDOUT_FILENO):
+			m_fd(p_fd)
+		{};
+
+		void Write(const OutputSegment *p_segments, const usize p_count) override {
+			for (usize first = 0; first < p_count; first += BatchSize) {
+				const usize count = std::min(BatchSize, p_count - first);
+				for (usize i = 0; i < count; ++ i) {
+					m_vecs[i].iov_base = const_cast<char*>(p_segments[first + i].data);
+					m_vecs[i].iov_len  = p_segments[first + i].size;
+				};
+
+				if (not WriteAll(m_vecs, m_vecs + count))
+					return; // Nowhere to report it, like std::cout
+			};
+		};
+
+	private:
+		// writev fails with more vectors than IOV_MAX
+#ifdef IOV_MAX
+		static constexpr usize BatchSize = IOV_MAX < 64? IOV_MAX : 64;
+#else
+		static constexpr usize BatchSize = 16; // The POSIX minimum
+#endif
+
+		bool WriteAll(iovec *p_vec, iovec *const p_end) {
+			while (p_vec != p_end) {
+				const ssize_t written = writev(m_fd, p_vec, p_end - p_vec);
+				if (written < 0) {
+					if (errno == EINTR)
+						continue;
+
+					return false;
+				};
+
+				// Skip what was written
+				usize left = written;
+				while (p_vec != p_end and left >= p_vec->iov_len)
+					left -= (p_vec ++)->iov_len;
+
+				if (p_vec != p_end) {
+					p_vec->iov_base = static_cast<char*>(p_vec->iov_base) + left;
+					p_vec->iov_len -= left;
+				};
+			};
+
+			return true;
+		};
+
+		int   m_fd;
+		iovec m_vecs[BatchSize];
+	}; // class FdSink
+#endif // SCBL_HAS_WRITEV
+
+	// Buffers the output of the functions, see Environment::GetOutput.
+	// It is written into the sink when the buffer reaches the threshold,
+	// when Flush is called and at the end of Environment::Run
+	class Output {
+	public:
+		static constexpr const usize DefaultThreshold = 64 * 1024;
+
+		Output(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_sink(nullptr),
+			m_threshold(DefaultThreshold),
+			m_buffer(p_resource)
+		{};
+
+		// The sink is not owned, nullptr discards the output
+		void SetSink(OutputSink *p_sink) {
+			Flush();
+
+			m_sink = p_sink;
+		};
+
+		OutputSink *GetSink() const {
+			return m_sink;
+		};
+
+		// 0 flushes after every write
+		void SetThreshold(const usize p_threshold) {
+			m_threshold = p_threshold;
+		};
+
+		usize GetThreshold() const {
+			return m_threshold;
+		};
+
+		void Write(const char *p_data, const usize p_size) {
+			// Big writes are not copied, they go to the sink
+			// together with the buffer
+			if (p_size >= m_threshold) {
+				const OutputSegment segments[2] = {
+					{m_buffer.data(), m_buffer.size()},
+					{p_data, p_size}
+				};
+
+				if (m_sink != nullptr)
+					m_sink->Write(segments, 2);
+
+				m_buffer.clear();
+
+				return;
+			};
+
+			m_buffer.append(p_data, p_size);
+			if (m_buffer.size() >= m_threshold)
+				Flush();
+		};
+
+		void Write(const std::string_view p_str) {
+			Write(p_str.data(), p_str.size());
+		};
+
+		void Put(const char p_ch) {
+			m_buffer.push_back(p_ch);
+			if (m_buffer.size() >= m_threshold)
+				Flush();
+		};
+
+		void Flush() {
+			if (m_buffer.empty())
+				return;
+
+			const OutputSegment segment = {m_buffer.data(), m_buffer.size()};
+			if (m_sink != nullptr)
+				m_sink->Write(&segment, 1);
+
+			m_buffer.clear();
+		};
+
+		// Bytes waiting to be flushed
+		usize Buffered() const {
+			return m_buffer.size();
+		};
+
+	private:
+		OutputSink *m_sink;
+		usize m_threshold;
+
+		std::pmr::string m_buffer;
+	}; // class Output
+
+	// Open addressing index of the names of the functions and constants,
+	// so a name is found with one probe whatever it names. The control
+	// byte of each entry is checked 8 at once (see Tools::Swar), the
+	// entries point to the names and values in the maps. Removed entries
+	// are marked as deleted until the table is grown again
+	class SymbolTable {
+	public:
+		struct Symbol {
+		public:
+			const std::pmr::string *name;
+
+			Func  *func;     // nullptr if not a function
+			Const *constant; // nullptr if not a constant
+		}; // struct Symbol
+
+		SymbolTable(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_ctrl(p_resource),
+			m_symbols(p_resource),
+			m_size(0),
+			m_deleted(0)
+		{};
+
+		Symbol *Find(const std::string_view p_name) {
+			if (m_size == 0)
+				return nullptr;
+
+			const u64 hash = Tools::HashName(p_name);
+			const u8  tag  = hash >> 57;
+
+			const usize mask = m_ctrl.size() / GroupSize - 1;
+			usize group = hash & mask;
+			for (usize step = 1;; ++ step) {
+				const u64 ctrl = Tools::Swar::Load(reinterpret_cast<const char*>(&m_ctrl[group * GroupSize]));
+
+				for (u64 match = Tools::Swar::MatchByte(ctrl, tag); match != 0; match &= match - 1) {
+					Symbol &symbol = m_symbols[group * GroupSize + Tools::Swar::FirstByte(match)];
+					if (*symbol.name == p_name)
+						return &symbol;
+				};
+
+				// Nothing was ever put after an empty entry, deleted
+				// ones have the 0x40 bit set too
+				if (ctrl & ~(ctrl << 1) & Tools::Swar::High)
+					return nullptr;
+
+				group = (group + step) & mask;
+			};
+		};
+
+		// Adds the name or finds it, the name has to live as long as
+		// the symbol
+		Symbol &Insert(const std::pmr::string &p_name) {
+			Symbol *symbol = Find(p_name);
+			if (symbol != nullptr)
+				return *symbol;
+
+			// At most 7/8 of the entries are taken, deleted ones included
+			if ((m_size + m_deleted + 1) * 8 > m_ctrl.size() * 7)
+				Grow();
+
+			++ m_size;
+
+			return Place({&p_name, nullptr, nullptr});
+		};
+
+		void Erase(Symbol &p_symbol) {
+			m_ctrl[&p_symbol - m_symbols.data()] = Deleted;
+
+			-- m_size;
+			++ m_deleted;
+		};
+
+		void Clear() {
+			std::fill(m_ctrl.begin(), m_ctrl.end(), Empty);
+			m_size    = 0;
+			m_deleted = 0;
+		};
+
+		usize Size() const {
+			return m_size;
+		};
+
+		MemUsage GetMemUsage() const {
+			return {m_size, Tools::VectorBytes(m_ctrl) + Tools::VectorBytes(m_symbols)};
+		};
+
+	private:
+		static constexpr const usize GroupSize = 8;
+		static constexpr const u8    Empty     = 0x80;
+		static constexpr const u8    Deleted   = 0xFE;
+
+		// Puts the symbol into the first empty or deleted entry of its probe
+		Symbol &Place(const Symbol &p_symbol) {
+			const u64 hash = Tools::HashName(*p_symbol.name);
+
+			const usize mask = m_ctrl.size() / GroupSize - 1;
+			usize group = hash & mask;
+			for (usize step = 1;; ++ step) {
+				const u64 empty = Tools::Swar::Load(reinterpret_cast<const char*>(&m_ctrl[group * GroupSize])) & Tools::Swar::High;
+				if (empty != 0) {
+					const usize idx = group * GroupSize + Tools::Swar::FirstByte(empty);
+					m_ctrl[idx]    = hash >> 57;
+					m_symbols[idx] = p_symbol;
+
+					return m_symbols[idx];
+				};
+
+				group = (group + step) & mask;
+			};
+		};
+
+		// Only drops the deleted entries if the symbols would take up
+		// less than half of the table after that
+		void Grow() {
+			std::pmr::vector<Symbol> symbols(m_symbols.get_allocator());
+			for (usize i = 0; i < m_ctrl.size(); ++ i) {
+				if (m_ctrl[i] != Empty and m_ctrl[i] != Deleted)
+					symbols.push_back(m_symbols[i]);
+			};
+
+			usize size = m_ctrl.empty()? GroupSize * 2 : m_ctrl.size();
+			if ((m_size + 1) * 2 > size)
+				size *= 2;
+
+			m_ctrl.assign(size, Empty);
+			m_symbols.resize(size);
+			m_deleted = 0;
+
+			for (const Symbol &symbol : symbols)
+				Place(symbol);
+		};
+
+		std::pmr::vector<u8>     m_ctrl; // Top 7 bits of the hash of each entry, Empty or Deleted
+		std::pmr::vector<Symbol> m_symbols;
+
+		usize m_size, m_deleted;
+	}; // class SymbolTable
+
+	template <typename Context, typename... Fns>
+	class StaticEnvironment;
+
+	class Environment {
+		// Runs the code with ExecuteWith of its own functions
+		template <typename Context, typename... Fns>
+		friend class StaticEnvironment;
+
+	public:
+		using FuncMap  = std::pmr::unordered_map<std::pmr::string, Func>;
+		using ConstMap = std::pmr::unordered_map<std::pmr::string, Const>;
+
+		Environment(std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()):
+			m_params(p_resource),
+			m_segmentRefs(p_resource),
+			m_segments(p_resource),
+			m_args(p_resource),
+			m_batchEnds(p_resource),
+			m_batchFrames(p_resource),
+			m_batch(nullptr),
+			m_bindings(nullptr),
+			m_frameBegin(0),
+			m_funcs(p_resource),
+			m_consts(p_resource),
+			m_funcNames(p_resource),
+			m_symbols(p_resource),
+			m_paramCaches(p_resource),
+			m_registers(p_resource),
+			m_registerNames(p_resource),
+			m_programs(p_resource),
+			m_programIdx(p_resource),
+			m_evalLexer(p_resource),
+			m_evalCapacity(EvalCacheBytes),
+			m_evalBytes(0),
+			m_evalHits(0),
+			m_evalMisses(0),
+			m_memo(p_resource),
+			m_memoKey(p_resource),
+			m_effects(p_resource),
+			m_memoCapacity(MemoEntries),
+			m_memoHits(0),
+			m_memoMisses(0),
+			m_recording(false),
+			m_output(p_resource),
+			m_constVersion(0),
+			m_cacheEpoch(0),
+			m_runs(0),
+			m_run(0),
+			m_callIdx(0),
+			m_constBytes(0),
+			m_peakParams(0),
+			m_runPeakParams(0),
+			m_runPeakConsts(0),
+			m_padEnd(0),
+			m_padSize(0),
+			m_typed(false),
+			m_argLayout(Layout::BigEndian),
+			m_userData(nullptr),
+			m_execute(nullptr)
+		{};
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		Environment(
+			const std::pmr::vector<Structcode> &p_scode,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			Environment(p_resource)
+		{
+			Run(p_scode);
+		};
+
+		void Run(const std::pmr::vector<Structcode> &p_scode) {
+			const Error error = TryRun(p_scode);
+			if (error)
+				ThrowError(error);
+		};
+
+		void Run(const Compiler &p_compiler) {
+			const Error error = TryRun(p_compiler);
+			if (error)
+				ThrowError(error);
+		};
+
+		void Run(const std::pmr::vector<Structcode> &p_scode, const Bindings &p_bindings) {
+			const Error error = TryRun(p_scode, p_bindings);
+			if (error)
+				ThrowError(error);
+		};
+
+		void Run(const Compiler &p_compiler, const Bindings &p_bindings) {
+			const Error error = TryRun(p_compiler, p_bindings);
+			if (error)
+				ThrowError(error);
+		};
+
+		void Eval(const std::string_view p_code) {
+			const Error error = TryEval(p_code);
+			if (error)
+				ThrowError(error);
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		Error TryRun(const std::pmr::vector<Structcode> &p_scode) {
+			const Error error = Execute(p_scode, nullptr);
+			m_output.Flush();
+
+			return error;
+		};
+
+		// Same as TryRun(p_compiler.GetStructcode()), but the parameters
+		// of every call are kept and only assembled again if one of
+		// their constants was set since. Runs of the same program
+		// with the same constants skip the lookups, only the bytes
+		// of the constants are copied again
+		Error TryRun(const Compiler &p_compiler) {
+			const Error error = Execute(p_compiler.GetStructcode(), &GetParamCache(p_compiler.GetVersion()));
+			m_output.Flush();
+
+			return error;
+		};
+
+		// Runs code with slots, which get their values from p_bindings
+		Error TryRun(const std::pmr::vector<Structcode> &p_scode, const Bindings &p_bindings) {
+			m_bindings = &p_bindings;
+			const Error error = TryRun(p_scode);
+			m_bindings = nullptr;
+
+			return error;
+		};
+
+		// Calls are only assembled again if the constants or the values
+		// bound to the slots they use changed
+		Error TryRun(const Compiler &p_compiler, const Bindings &p_bindings) {
+			m_bindings = &p_bindings;
+			const Error error = TryRun(p_compiler);
+			m_bindings = nullptr;
+
+			return error;
+		};
+
+		void ClearParamCache() {
+			m_paramCaches.clear();
+		};
+
+		// Lexes, compiles and runs p_code. The compiled programs are
+		// kept by their code, so running the same code again skips the
+		// lexing and compiling. Code which does not compile is not kept
+		Error TryEval(const std::string_view p_code) {
+			const auto found = m_programIdx.find(p_code);
+			if (found != m_programIdx.end()) {
+				++ m_evalHits;
+				m_programs.splice(m_programs.begin(), m_programs, found->second);
+			} else {
+				++ m_evalMisses;
+
+				// The lexer needs the code in a std::string
+				m_evalCode.assign(p_code);
+				Error error = m_evalLexer.TryLex(m_evalCode);
+				if (error) {
+					m_evalLexer.Locate(error);
+
+					return error;
+				};
+
+				m_programs.emplace_front(p_code, GetResource());
+				CachedProgram &program = m_programs.front();
+
+				error = program.compiler.TryCompile(m_evalLexer);
+				if (error) {
+					m_programs.pop_front();
+
+					return error;
+				};
+
+				const Compiler::MemStats stats = program.compiler.GetMemStats();
+				program.bytes =
+					sizeof(CachedProgram) +
+					Tools::StringBytes(program.code) +
+					stats.structcode.bytes +
+					stats.sourceMap.bytes;
+
+				m_programIdx.emplace(program.code, m_programs.begin());
+				m_evalBytes += program.bytes;
+			};
+
+			// A program bigger than the whole cache is only
+			// dropped after it is run
+			EvictPrograms(1);
+
+			const CachedProgram &program = m_programs.front();
+			Error error = TryRun(program.compiler);
+			if (error and program.compiler.GetSourceMap().Locate(error))
+				LineIndex(std::string(p_code), GetResource()).Locate(error);
+
+			EvictPrograms(0);
+
+			return error;
+		};
+
+		// Most bytes the programs kept by Eval can take, 0 disables it
+		void SetEvalCacheCapacity(const usize p_bytes) {
+			m_evalCapacity = p_bytes;
+			EvictPrograms(0);
+		};
+
+		void ClearEvalCache() {
+			m_programs.clear();
+			m_programIdx.clear();
+			m_evalBytes = 0;
+		};
+
+		struct EvalStats {
+		public:
+			u64 hits, misses;
+
+			usize programs;
+			usize bytes, capacity;
+		}; // struct EvalStats
+
+		// Most parameters of pure functions kept with the constants they
+		// set, the memo starts over once it is full. 0 disables it
+		void SetMemoCapacity(const usize p_entries) {
+			m_memoCapacity = p_entries;
+			if (m_memo.size() > m_memoCapacity)
+				m_memo.clear();
+		};
+
+		void ClearMemo() {
+			m_memo.clear();
+		};
+
+		struct MemoStats {
+		public:
+			u64 hits, misses;
+
+			usize entries, capacity;
+		}; // struct MemoStats
+
+		MemoStats GetMemoStats() const {
+			MemoStats stats;
+			stats.hits     = m_memoHits;
+			stats.misses   = m_memoMisses;
+			stats.entries  = m_memo.size();
+			stats.capacity = m_memoCapacity;
+
+			return stats;
+		};
+
+		EvalStats GetEvalStats() const {
+			EvalStats stats;
+			stats.hits     = m_evalHits;
+			stats.misses   = m_evalMisses;
+			stats.programs = m_programs.size();
+			stats.bytes    = m_evalBytes;
+			stats.capacity = m_evalCapacity;
+
+			return stats;
+		};
+
+		// Output the functions can write into, flushed at the end of Run
+		Output &GetOutput() {
+			return m_output;
+		};
+
+		void SetUserData(void* p_userData) {
+			m_userData = p_userData;
+		};
+
+		void* GetUserData() {
+			return m_userData;
+		};
+
+#ifndef SCBL_DONT_USE_EXCEPTIONS
+		void SetFunc(
+			const std::string &p_name,
+			const Func &p_func
+		) {
+			const Error error = TrySetFunc(p_name, p_func);
+			if (error)
+				ThrowError(error);
+		};
+
+		void SetConst(
+			const std::string &p_name,
+			const Const &p_const
+		) {
+			const Error error = TrySetConst(p_name, p_const);
+			if (error)
+				ThrowError(error);
+		};
+
+		usize AddRegister(const std::string &p_name) {
+			usize idx = 0;
+			const Error error = TryAddRegister(p_name, idx);
+			if (error)
+				ThrowError(error);
+
+			return idx;
+		};
+
+		void RemoveFunc(const std::string &p_name) {
+			const Error error = TryRemoveFunc(p_name);
+			if (error)
+				ThrowError(error);
+		};
+
+		void RemoveConst(const std::string &p_name) {
+			const Error error = TryRemoveConst(p_name);
+			if (error)
+				ThrowError(error);
+		};
+#endif // not SCBL_DONT_USE_EXCEPTIONS
+
+		Error TrySetFunc(
+			const std::string &p_name,
+			const Func &p_func
+		) {
+			if (not CheckName(p_name))
+				return Error(ErrorCode::InvalidName, ErrorSubject::Id, p_name);
+
+			if (p_func.pure and not IsMemoizable(p_func))
+				return Error(ErrorCode::InvalidPureFunc, ErrorSubject::Id, p_name);
+
+			const SymbolTable::Symbol *symbol = FindSymbol(p_name);
+			if (symbol != nullptr and symbol->constant != nullptr)
+				return Error(ErrorCode::ConstNameTaken, ErrorSubject::Id, p_name);
+
+			// Replaced functions keep their slot and their entry, but
+			// their cached calls could be for the other kind of callback
+			if (symbol != nullptr) {
+				const u32 slot = symbol->func->slot;
+				*symbol->func = p_func;
+				symbol->func->slot = slot;
+				++ m_cacheEpoch;
+
+				return Error();
+			};
+
+			const auto func = m_funcs.emplace(std::pmr::string(p_name, GetResource()), p_func).first;
+			func->second.slot = m_funcNames.size();
+			m_funcNames.push_back(func->first);
+			AddSymbol(func->first).func = &func->second;
+
+			return Error();
+		};
+
+		Error TrySetConst(
+			const std::string &p_name,
+			const Const &p_const
+		) {
+			if (not CheckName(p_name))
+				return Error(ErrorCode::InvalidName, ErrorSubject::Id, p_name);
+
+			const SymbolTable::Symbol *symbol = FindSymbol(p_name);
+			if (symbol != nullptr and symbol->func != nullptr)
+				return Error(ErrorCode::FuncNameTaken, ErrorSubject::Id, p_name);
+
+			Const &constant = symbol != nullptr? *symbol->constant : NewConst(p_name);
+			m_constBytes -= constant.Size();
+			m_constBytes += p_const.Size();
+			if (m_constBytes > m_runPeakConsts)
+				m_runPeakConsts = m_constBytes;
+
+			constant = p_const;
+			constant.version     = ++ m_constVersion;
+			constant.producedRun = 0;
+			Record(constant);
+
+			return Error();
+		};
+
+		// The slot of a removed function is not given to another one
+		Error TryRemoveFunc(const std::string &p_name) {
+			SymbolTable::Symbol *symbol = FindSymbol(p_name);
+			if (symbol == nullptr or symbol->func == nullptr)
+				return Error(ErrorCode::NoSuchFunc, ErrorSubject::Id, p_name);
+
+			m_symbols.Erase(*symbol);
+			m_funcs.erase(m_funcs.find(std::pmr::string(p_name, GetResource())));
+			++ m_cacheEpoch;
+
+			return Error();
+		};
+
+		// The constant of a register is put back, without a value
+		Error TryRemoveConst(const std::string &p_name) {
+			SymbolTable::Symbol *symbol = FindSymbol(p_name);
+			if (symbol == nullptr or symbol->constant == nullptr)
+				return Error(ErrorCode::NoSuchConst, ErrorSubject::Id, p_name);
+
+			m_constBytes -= symbol->constant->Size();
+
+			m_symbols.Erase(*symbol);
+			m_consts.erase(m_consts.find(std::pmr::string(p_name, GetResource())));
+			++ m_cacheEpoch;
+
+			FindRegisters();
+
+			return Error();
+		};
+
+		const FuncMap &GetFuncs() const {
+			return m_funcs;
+		};
+
+		// Functions of a StaticEnvironment are left out if this is not
+		// one, nothing could call them here
+		void SetFuncs(const FuncMap &p_funcs) {
+			m_funcs = p_funcs;
+			++ m_cacheEpoch;
+
+			if (m_execute == nullptr) {
+				for (auto it = m_funcs.begin(); it != m_funcs.end();) {
+					if (it->second.staticIdx != Func::Dynamic)
+						it = m_funcs.erase(it);
+					else
+						++ it;
+				};
+			};
+
+			m_funcNames.clear();
+			for (auto &func : m_funcs) {
+				func.second.slot = m_funcNames.size();
+				m_funcNames.push_back(func.first);
+			};
+
+			IndexSymbols();
+		};
+
+		// Names of the functions by their slot
+		const std::pmr::vector<std::pmr::string> &GetFuncNames() const {
+			return m_funcNames;
+		};
+
+		// Records the last p_capacity function calls. If p_dumpFile is
+		// not empty, the trace is dumped into it on runtime errors
+		void EnableTrace(const usize p_capacity = 4096, const std::string &p_dumpFile = "") {
+			m_trace         = std::make_unique<TraceBuffer>(p_capacity);
+			m_traceDumpFile = p_dumpFile;
+		};
+
+		void DisableTrace() {
+			m_trace.reset();
+		};
+
+		// nullptr if tracing is disabled
+		const TraceBuffer *GetTrace() const {
+			return m_trace.get();
+		};
+
+		bool DumpTrace(std::ostream &p_stream) const {
+			if (m_trace == nullptr)
+				return false;
+
+			return m_trace->Dump(p_stream, m_funcNames);
+		};
+
+		bool DumpTrace(const std::string &p_file) const {
+			std::ofstream file(p_file, std::ios::binary);
+			if (not file.is_open())
+				return false;
+
+			return DumpTrace(file);
+		};
+
+		const ConstMap &GetConsts() const {
+			return m_consts;
+		};
+
+		void SetConsts(const ConstMap &p_consts) {
+			m_consts = p_consts;
+			++ m_cacheEpoch;
+			IndexSymbols();
+
+			m_constBytes = 0;
+			for (auto &constant : m_consts) {
+				m_constBytes += constant.second.Size();
+				constant.second.version     = ++ m_constVersion;
+				constant.second.producedRun = 0;
+			};
+
+			FindRegisters();
+		};
+
+		// Registers are constants the functions can set by their index,
+		// without looking them up or allocating a new value, for results
+		// the next calls use. An existing constant keeps its value
+		Error TryAddRegister(const std::string &p_name, usize &p_idx) {
+			for (usize i = 0; i < m_registerNames.size(); ++ i) {
+				if (std::string_view(m_registerNames[i]) == p_name) {
+					p_idx = i;
+
+					return Error();
+				};
+			};
+
+			if (m_registerNames.size() >= MaxRegisters)
+				return Error(ErrorCode::TooManyRegisters, ErrorSubject::Text, p_name);
+
+			if (not CheckName(p_name))
+				return Error(ErrorCode::InvalidName, ErrorSubject::Id, p_name);
+
+			const SymbolTable::Symbol *symbol = FindSymbol(p_name);
+			if (symbol != nullptr and symbol->func != nullptr)
+				return Error(ErrorCode::FuncNameTaken, ErrorSubject::Id, p_name);
+
+			// Rehashing the map does not move its values
+			Const &reg = symbol != nullptr? *symbol->constant : NewConst(p_name);
+			if (symbol == nullptr)
+				reg.version = ++ m_constVersion;
+
+			if (reg.value.capacity() < RegisterBytes)
+				reg.value.reserve(RegisterBytes);
+
+			p_idx = m_registerNames.size();
+			m_registerNames.push_back(std::pmr::string(p_name, GetResource()));
+			m_registers.push_back(&reg);
+
+			return Error();
+		};
+
+		// The integer as p_size bytes, big endian or like Const::Native
+		void SetRegister(
+			const usize p_idx,
+			const u64 p_num,
+			const u8 p_size = Const::Size64b,
+			const Layout p_layout = Layout::BigEndian
+		) {
+			Const &reg = Register(p_idx);
+			m_constBytes -= reg.Size();
+
+			reg.value.resize(p_size);
+			if (p_layout == Layout::Native)
+				Tools::StoreNative(p_num, p_size, reg.value.data());
+			else {
+				for (u8 i = 0; i < p_size; ++ i)
+					reg.value[i] = static_cast<u8>(p_num >> ((p_size - i - 1) * 010));
+			};
+
+			reg.kind  = ArgKind::Int;
+			reg.width = p_size;
+			reg.align = p_layout == Layout::Native? p_size : 1;
+			SetRegisterDone(reg);
+		};
+
+		// The string with a null terminator, like Const(std::string). Only
+		// strings longer than RegisterBytes allocate
+		void SetRegister(const usize p_idx, const std::string_view p_str) {
+			Const &reg = Register(p_idx);
+			m_constBytes -= reg.Size();
+
+			reg.value.resize(p_str.size() + 1);
+			std::memcpy(reg.value.data(), p_str.data(), p_str.size());
+			reg.value.back() = 0;
+
+			reg.kind  = ArgKind::Str;
+			reg.width = Const::Size8b;
+			reg.align = 1;
+			SetRegisterDone(reg);
+		};
+
+		const Const &GetRegister(const usize p_idx) {
+			return Register(p_idx);
+		};
+
+		usize GetRegisterCount() const {
+			return m_registerNames.size();
+		};
+
+		std::pmr::memory_resource *GetResource() const {
+			return m_params.get_allocator().resource();
+		};
+
+		struct MemStats {
+		public:
+			MemUsage funcs;
+			MemUsage consts;
+			MemUsage symbols; // Index of the names of both
+			MemUsage params;
+			MemUsage paramCache; // Cached calls of Run(Compiler)
+			MemUsage evalCache;  // Programs kept by Eval
+			MemUsage memo;       // Calls of pure functions
+
+			usize peakParams; // Biggest parameters of a call, in bytes
+
+			// High water marks of the last run, in bytes. Constant
+			// values only count the ones set with SetConst, shared
+			// blobs are counted here but not in consts
+			usize runPeakParams;
+			usize runPeakConsts;
+		}; // struct MemStats
+
+		MemStats GetMemStats() const {
+			MemStats stats;
+			stats.funcs.count = m_funcs.size();
+			stats.funcs.bytes = Tools::MapBytes(m_funcs);
+			for (const auto &func : m_funcs)
+				stats.funcs.bytes += Tools::StringBytes(func.first);
+
+			stats.consts.count = m_consts.size();
+			stats.consts.bytes = Tools::MapBytes(m_consts);
+			for (const auto &constant : m_consts)
+				stats.consts.bytes +=
+					Tools::StringBytes(constant.first) +
+					Tools::VectorBytes(constant.second.value);
+
+			stats.symbols = m_symbols.GetMemUsage();
+
+			stats.params.count = m_params.size();
+			stats.params.bytes =
+				Tools::VectorBytes(m_params) +
+				Tools::VectorBytes(m_segmentRefs) +
+				Tools::VectorBytes(m_segments) +
+				Tools::VectorBytes(m_args) +
+				Tools::VectorBytes(m_batchEnds) +
+				Tools::VectorBytes(m_batchFrames);
+
+			stats.paramCache.count = 0;
+			stats.paramCache.bytes = Tools::VectorBytes(m_paramCaches);
+			for (const ParamCache &cache : m_paramCaches) {
+				stats.paramCache.count += cache.calls.size();
+				stats.paramCache.bytes += Tools::VectorBytes(cache.calls);
+				for (const CachedCall &call : cache.calls)
+					stats.paramCache.bytes +=
+						Tools::VectorBytes(call.params) +
+						Tools::VectorBytes(call.consts) +
+						Tools::VectorBytes(call.slots) +
+						Tools::VectorBytes(call.segments);
+			};
+
+			stats.evalCache.count = m_programs.size();
+			stats.evalCache.bytes = m_evalBytes + Tools::MapBytes(m_programIdx);
+
+			stats.memo.count = m_memo.size();
+			stats.memo.bytes = Tools::MapBytes(m_memo) + Tools::StringBytes(m_memoKey);
+			for (const auto &memo : m_memo) {
+				stats.memo.bytes +=
+					Tools::StringBytes(memo.first) +
+					Tools::VectorBytes(memo.second.effects);
+
+				for (const auto &effect : memo.second.effects)
+					stats.memo.bytes += Tools::VectorBytes(effect.second.value);
+			};
+
+			stats.peakParams    = m_peakParams;
+			stats.runPeakParams = m_runPeakParams;
+			stats.runPeakConsts = m_runPeakConsts;
+
+			return stats;
+		};
+
+	private:
+		// Programs Run(Compiler) keeps the parameters of
+		static constexpr const usize ParamCachePrograms = 8;
+
+		// Most registers of an environment
+		static constexpr const usize MaxRegisters = 64;
+
+		// Bytes reserved for the value of every register
+		static constexpr const usize RegisterBytes = 32;
+
+		// Default capacity of the memo of pure functions, in calls
+		static constexpr const usize MemoEntries = 4096;
+
+		// Default capacity of the programs kept by Eval, in bytes
+		static constexpr const usize EvalCacheBytes = 1024 * 1024;
+
+		// Most calls passed to a batch callback at once
+		static constexpr const usize MaxBatchFrames = 4096;
+
+		// Alignment of the frames of a batch, for Layout::Native
+		static constexpr const usize FrameAlign = 8;
+
+		// Segment of the parameters of a segment callback, data is
+		// nullptr for bytes from the code at offset in the parameters
+		struct SegmentRef {
+		public:
+			const u8 *data;
+			usize offset, size;
+		}; // struct SegmentRef
+
+		// Parameters of one call, valid while the epoch and the
+		// versions of its constants did not change
+		struct CachedCall {
+		public:
+			CachedCall(std::pmr::memory_resource *p_resource):
+				func(nullptr),
+				end(0),
+				epoch(0),
+				checked(0),
+				lazy(false),
+				params(p_resource),
+				consts(p_resource),
+				slots(p_resource),
+				segments(p_resource)
+			{};
+
+			const Func *func;
+			usize end;   // Index of the last structcode of the call
+			u64   epoch;
+			u64   checked; // Last constant version the constants were checked at
+			bool  lazy;    // Uses lazy constants, which are checked every time
+
+			// Only the bytes from the code if there are segments, the
+			// constants are copied from them again for other callbacks
+			std::pmr::vector<u8> params;
+			std::pmr::vector<std::pair<Const*, u64>> consts;
+			std::pmr::vector<std::pair<u8, u64>> slots; // Indexes and versions of the values
+			std::pmr::vector<SegmentRef> segments;
+		}; // struct CachedCall
+
+		// A call with its parameters, ready to be made
+		struct PreparedCall {
+		public:
+			const Func *func = nullptr;
+
+			ParamView     params;
+			ParamSegments segments; // For segment callbacks
+		}; // struct PreparedCall
+
+		struct ParamCache {
+		public:
+			ParamCache(const u64 p_version, std::pmr::memory_resource *p_resource):
+				version(p_version),
+				lastRun(0),
+				calls(p_resource)
+			{};
+
+			u64 version;
+			u64 lastRun;
+
+			std::pmr::vector<CachedCall> calls; // By the order of the calls
+		}; // struct ParamCache
+
+		// Replaces the least recently run program if all are taken
+		ParamCache &GetParamCache(const u64 p_version) {
+			ParamCache *cache = nullptr;
+			for (ParamCache &program : m_paramCaches) {
+				if (program.version == p_version) {
+					cache = &program;
+
+					break;
+				};
+			};
+
+			if (cache == nullptr) {
+				if (m_paramCaches.size() < ParamCachePrograms) {
+					m_paramCaches.push_back(ParamCache(p_version, GetResource()));
+					cache = &m_paramCaches.back();
+				} else {
+					cache = &m_paramCaches.front();
+					for (ParamCache &program : m_paramCaches) {
+						if (program.lastRun < cache->lastRun)
+							cache = &program;
+					};
+
+					cache->version = p_version;
+					cache->calls.clear();
+				};
+			};
+
+			cache->lastRun = ++ m_runs;
+
+			return *cache;
+		};
+
+		Const &Register(const usize p_idx) {
+			return *m_registers[p_idx];
+		};
+
+		// Finds the constants of the registers again after the map was
+		// changed, they are put back if they were removed
+		void FindRegisters() {
+			for (usize i = 0; i < m_registerNames.size(); ++ i) {
+				const SymbolTable::Symbol *symbol = FindSymbol(m_registerNames[i]);
+				Const &reg = symbol != nullptr and symbol->constant != nullptr?
+					*symbol->constant : NewConst(m_registerNames[i]);
+
+				if (reg.value.capacity() < RegisterBytes)
+					reg.value.reserve(RegisterBytes);
+
+				m_registers[i] = &reg;
+			};
+		};
+
+		void SetRegisterDone(Const &p_reg) {
+			p_reg.blob.reset();
+			p_reg.producer = nullptr;
+			p_reg.version  = ++ m_constVersion;
+
+			m_constBytes += p_reg.Size();
+			if (m_constBytes > m_runPeakConsts)
+				m_runPeakConsts = m_constBytes;
+
+			Record(p_reg);
+		};
+
+		// Keeps the value a pure function set the constant to
+		void Record(Const &p_const) {
+			if (m_recording)
+				m_effects.push_back({&p_const, p_const});
+		};
+
+		// Static functions are called before the memo is checked
+		static bool IsMemoizable(const Func &p_func) {
+			return
+				p_func.staticIdx != Func::Dynamic or
+				(p_func.callback and not p_func.segmentCallback and not p_func.batchCallback);
+		};
+
+		// Pure functions are called once for the same parameters, the
+		// constants they set are set again from the memo after that
+		void CallPure(const Func &p_func, const ParamView p_params) {
+			m_memoKey.assign(reinterpret_cast<const char*>(&p_func.slot), sizeof(p_func.slot));
+			m_memoKey.append(reinterpret_cast<const char*>(p_params.Data()), p_params.Size());
+
+			// Entries from before the maps could have been changed could
+			// point to removed constants or be for another function
+			auto memo = m_memo.find(m_memoKey);
+			if (memo != m_memo.end() and memo->second.epoch == m_cacheEpoch) {
+				++ m_memoHits;
+				for (const auto &effect : memo->second.effects) {
+					Const &constant = *effect.first;
+					m_constBytes -= constant.Size();
+
+					// Keeps the capacity of registers
+					constant.value.assign(effect.second.value.begin(), effect.second.value.end());
+					constant.blob     = effect.second.blob;
+					constant.producer = effect.second.producer;
+					constant.kind     = effect.second.kind;
+					constant.width    = effect.second.width;
+					constant.align    = effect.second.align;
+					constant.perRun   = effect.second.perRun;
+					constant.version  = ++ m_constVersion;
+
+					m_constBytes += constant.Size();
+				};
+
+				if (m_constBytes > m_runPeakConsts)
+					m_runPeakConsts = m_constBytes;
+
+				return;
+			};
+
+			++ m_memoMisses;
+
+			const u64 epoch = m_cacheEpoch;
+			m_effects.clear();
+			m_recording = true;
+			p_func.callback(p_params, m_userData);
+			m_recording = false;
+
+			// Calls which set nothing are not kept, their only effect could
+			// be one which can not be replayed, like output
+			if (m_effects.empty() or m_memoCapacity == 0)
+				return;
+
+			if (memo == m_memo.end()) {
+				if (m_memo.size() >= m_memoCapacity)
+					m_memo.clear();
+
+				memo = m_memo.emplace(m_memoKey, MemoEntry(GetResource())).first;
+			};
+
+			memo->second.epoch = epoch;
+			memo->second.effects.assign(m_effects.begin(), m_effects.end());
+		};
+
+		SymbolTable::Symbol *FindSymbol(const std::string_view p_name) {
+			return m_symbols.Find(p_name);
+		};
+
+		// The symbol of a name just added to one of the maps
+		SymbolTable::Symbol &AddSymbol(const std::pmr::string &p_name) {
+			return m_symbols.Insert(p_name);
+		};
+
+		// Indexes the maps again after one of them was replaced
+		void IndexSymbols() {
+			m_symbols.Clear();
+			for (auto &func : m_funcs)
+				m_symbols.Insert(func.first).func = &func.second;
+
+			for (auto &constant : m_consts)
+				m_symbols.Insert(constant.first).constant = &constant.second;
+		};
+
+		// Adds a constant which is not in the map yet
+		Const &NewConst(const std::string_view p_name) {
+			const auto constant = m_consts.emplace(std::pmr::string(p_name, GetResource()), Const()).first;
+			AddSymbol(constant->first).constant = &constant->second;
+
+			return constant->second;
+		};
+
+		// A compiled program kept by Eval, by the order of the last run
+		struct CachedProgram {
+		public:
+			CachedProgram(const std::string_view p_code, std::pmr::memory_resource *p_resource):
+				code(p_code, p_resource),
+				compiler(p_resource),
+				bytes(0)
+			{};
+
+			std::pmr::string code;
+			Compiler compiler;
+			usize bytes;
+		}; // struct CachedProgram
+
+		using ProgramList = std::pmr::list<CachedProgram>;
+
+		// Constants a call of a pure function set, with their values
+		using Effects = std::pmr::vector<std::pair<Const*, Const>>;
+
+		struct MemoEntry {
+		public:
+			MemoEntry(std::pmr::memory_resource *p_resource):
+				epoch(0),
+				effects(p_resource)
+			{};
+
+			u64 epoch;
+			Effects effects;
+		}; // struct MemoEntry
+
+		// Drops the least recently run programs until they fit, but
+		// keeps the p_keep most recent ones
+		void EvictPrograms(const usize p_keep) {
+			while (m_evalBytes > m_evalCapacity and m_programs.size() > p_keep) {
+				const CachedProgram &program = m_programs.back();
+
+				m_evalBytes -= program.bytes;
+				m_programIdx.erase(program.code);
+				m_programs.pop_back();
+			};
+		};
+
+		// Lazy constants get their value first, their version only
+		// changes if the value did. If no constant was set since the
+		// last check, the versions are not compared again
+		bool IsFresh(CachedCall &p_call) {
+			if (p_call.func == nullptr or p_call.epoch != m_cacheEpoch)
+				return false;
+
+			if (p_call.checked != m_constVersion or p_call.lazy) {
+				bool lazy = false;
+				for (const auto &constant : p_call.consts) {
+					if (constant.first->producer) {
+						lazy = true;
+						Produce(*constant.first);
+					};
+
+					if (constant.first->version != constant.second)
+						return false;
+				};
+
+				p_call.checked = m_constVersion;
+				p_call.lazy    = lazy;
+			};
+
+			for (const auto &slot : p_call.slots) {
+				const Const *value = m_bindings == nullptr? nullptr : m_bindings->Get(slot.first);
+				if (value == nullptr or value->version != slot.second)
+					return false;
+			};
+
+			return true;
+		};
+
+		// Makes the value of a lazy constant, unless it was made for this
+		// call already (or this run, if it is made once per run)
+		void Produce(Const &p_const) {
+			if (p_const.producedRun == m_run and (p_const.perRun or p_const.producedCall == m_callIdx))
+				return;
+
+			p_const.producedRun  = m_run;
+			p_const.producedCall = m_callIdx;
+
+			Const value = p_const.producer(m_userData);
+
+			const ParamView prev = p_const.Bytes(), next = value.Bytes();
+			if (
+				prev.Size() == next.Size() and
+				(next.Empty() or std::memcmp(prev.Data(), next.Data(), next.Size()) == 0) and
+				p_const.kind  == value.kind  and
+				p_const.width == value.width and
+				p_const.align == value.align
+			)
+				return;
+
+			m_constBytes -= p_const.Size();
+			m_constBytes += value.Size();
+			if (m_constBytes > m_runPeakConsts)
+				m_runPeakConsts = m_constBytes;
+
+			p_const.value   = std::move(value.value);
+			p_const.blob    = std::move(value.blob);
+			p_const.kind    = value.kind;
+			p_const.width   = value.width;
+			p_const.align   = value.align;
+			p_const.version = ++ m_constVersion;
+		};
+
+		// Functions of the Statics of ExecuteWith for the environments
+		// without static ones
+		struct NoStatics {
+		public:
+			static constexpr const bool Any = false;
+
+			static void Dispatch(Environment&, const u32, const ParamView) {};
+		}; // struct NoStatics
+
+		Error Execute(const std::pmr::vector<Structcode> &p_scode, ParamCache *p_cache) {
+			if (m_execute != nullptr)
+				return (this->*m_execute)(p_scode, p_cache);
+
+			return ExecuteWith<NoStatics>(p_scode, p_cache);
+		};
+
+		// Statics::Dispatch calls the functions with a staticIdx. It is
+		// known here, so they are called directly and can be inlined
+		template <typename Statics>
+		Error ExecuteWith(const std::pmr::vector<Structcode> &p_scode, ParamCache *p_cache) {
+			m_idx = 0;
+			++ m_run;
+
+			m_runPeakParams = 0;
+			m_runPeakConsts = m_constBytes;
+
+			usize callCount = 0;
+
+			m_typed = false;
+
+			m_scode = &p_scode;
+			for (
+				m_it = p_scode.cbegin();
+				m_it != p_scode.cend();
+				Inc()
+			) {
+				switch (m_it->type) {
+				case StructcodeType::Id: {
+						const usize callIdx = m_idx;
+
+						PreparedCall call;
+						if (not PrepareCall(p_cache, callCount, nullptr, call))
+							return m_error;
+
+						if (call.func->batchCallback)
+							RunBatch<Statics>(p_cache, callCount, callIdx, call);
+						else
+							Call<Statics>(*call.func, callIdx, call.params, call.segments);
+					};
+
+					break;
+
+				case StructcodeType::Typed:
+					m_typed     = true;
+					m_argLayout = static_cast<Layout>(std::get<u8>(m_it->data));
+					break;
+
+				case StructcodeType::Arg:
+					Inc(); // Report the argument itself
+					Fail(ErrorCode::UnexpectedScode);
 
-			case TokenType::Id:
-				return (std::string)
-					"identifier '" + std::get<std::string>(m_it->data) + "'";
+					return m_error;
 
-			case TokenType::Sym:
-				return (std::string)
-					"symbol '" + std::get<char>(m_it->data) + "'";
+				default:
+					Fail(ErrorCode::UnexpectedScode);
 
-			default: return "UNKNOWN";
+					return m_error;
+				};
 			};
+
+			return Error();
 		};
 
-		void CompStr() {
-			const std::string &value = std::get<std::string>(m_it->data);
-			bool strEndWithNull = true;
+		// Finds the function of the call at m_it and assembles its
+		// parameters, or takes them from the cache if they are fresh. With
+		// p_batch, the call is only prepared if it can join the batch of
+		// that function, otherwise false is returned without an error
+		bool PrepareCall(
+			ParamCache *p_cache,
+			usize &p_callCount,
+			const Func *p_batch,
+			PreparedCall &p_call
+		) {
+			m_callIdx = m_idx;
+
+			CachedCall *cached = nullptr;
+			if (p_cache != nullptr) {
+				if (p_callCount == p_cache->calls.size())
+					p_cache->calls.push_back(CachedCall(GetResource()));
+
+				cached = &p_cache->calls[p_callCount];
+				if (IsFresh(*cached)) {
+					const bool consts = not cached->consts.empty() or not cached->slots.empty();
+					if (p_batch != nullptr and not CanBatch(*p_batch, *cached->func, consts))
+						return false;
+
+					++ p_callCount;
+					m_it  = m_scode->cbegin() + cached->end;
+					m_idx = cached->end;
+
+					// Frames of a batch are all in m_params
+					p_call.func = cached->func;
+					if (p_batch != nullptr)
+						AddCached(*cached);
+					else if (cached->func->segmentCallback)
+						p_call.segments = Segments(cached->segments, cached->params);
+					else if (cached->segments.empty())
+						p_call.params = ParamView(cached->params);
+					else {
+						m_params.clear();
+						AddCached(*cached);
+						p_call.params = ParamView(m_params);
+					};
 
-			++ m_it;
-			if (IsSym('~'))
-				strEndWithNull = false;
-			else
-				-- m_it;
+					return true;
+				};
+			};
 
-			const u8 size = GetSize(1);
-			for (const char ch : value)
-				PushSplit(size, static_cast<u64>(ch));
+			const SymbolTable::Symbol *symbol = FindSymbol(std::get<std::pmr::string>(m_it->data));
+			if (symbol == nullptr or symbol->func == nullptr) {
+				if (p_batch != nullptr)
+					return false;
 
-			if (strEndWithNull)
-				PushSplit(size, 0);
-		};
+				return Fail(ErrorCode::NoSuchFunc);
+			};
 
-		void PushSplit(const u8 p_size, const u64 p_num) {
-			std::vector<u8> bytes;
-			m_byteSJ.SetList(bytes);
+			const Func &func = *symbol->func;
+			if (p_batch != nullptr and not CanBatch(*p_batch, func, false))
+				return false;
 
-			switch (p_size) {
-			case 1: bytes = {static_cast<u8>(p_num)}; break;
-			case 2: m_byteSJ.Split16(static_cast<u16>(p_num)); break;
-			case 4: m_byteSJ.Split32(static_cast<u32>(p_num)); break;
-			case 8: m_byteSJ.Split64(static_cast<u64>(p_num)); break;
+			// Constants are not copied for segment callbacks
+			const bool segmented = static_cast<bool>(func.segmentCallback);
+
+			// Frames of a batch are assembled after the ones before them
+			if (p_batch == nullptr)
+				m_params.clear();
+
+			m_segmentRefs.clear();
+			m_frameBegin = m_params.size();
+			m_batch      = p_batch;
+			Inc();
+
+			bool prepared;
+			if (cached == nullptr)
+				prepared = GetParams(nullptr, segmented? &m_segmentRefs : nullptr);
+			else {
+				cached->func = nullptr;
+				cached->consts.clear();
+				cached->slots.clear();
+
+				// The bytes of the constants are not kept, only where they go
+				prepared = GetParams(cached, &m_segmentRefs);
+				if (prepared)
+					KeepCall(*cached, func);
 			};
 
-			for (const u8 byte : bytes)
-				m_scode.push_back(Structcode(StructcodeType::Int, byte));
-		};
+			m_frameBegin = 0;
+			m_batch      = nullptr;
+			if (not prepared)
+				return false;
 
-		u8 GetSize(const u8 p_default) {
-			++ m_it;
-			if (IsSym(':')) {
-				++ m_it;
+			++ p_callCount;
 
-				std::string currTokName;
-				if (m_it != m_tokens->cend()) {
-					switch (m_it->type) {
-					case TokenType::Int: {
-							const u64 value = std::get<u64>(m_it->data);
-							switch (value) {
-							case 1: case 2:
-							case 4: case 8:
-								return value;
-
-							default:
-								throw CompilerException(
-										ExpectedErrorMsg(
-											"size of 1, 2, 4 or 8 bytes",
-											GetCurrTokName()
-										), m_it->line, m_it->col
-									);
-							};
-						};
+			p_call.func = &func;
+			if (segmented)
+				p_call.segments = Segments(m_segmentRefs, m_params);
+			else
+				p_call.params = ParamView(m_params);
 
-						// It returns or throws before it gets to this
-						// point, so it shouldnt even reach here
+			return true;
+		};
 
-					default:
-						currTokName = GetCurrTokName();
-						break;
-					};
-				} else {
-					currTokName = GetCurrTokName();
-					-- m_it;
-				};
+		// Keeps the parameters just assembled into m_params with segments
+		// for p_cached. For other callbacks, the constants are copied into
+		// m_params after that. The values of slots could be in bindings
+		// which are gone the next run, so calls using them keep a copy
+		void KeepCall(CachedCall &p_cached, const Func &p_func) {
+			p_cached.func    = &p_func;
+			p_cached.end     = m_idx;
+			p_cached.epoch   = m_cacheEpoch;
+			p_cached.checked = m_constVersion;
+			p_cached.lazy    = false;
+			for (const auto &constant : p_cached.consts)
+				p_cached.lazy = p_cached.lazy or constant.first->producer;
+
+			p_cached.params.assign(m_params.begin() + m_frameBegin, m_params.end());
+			p_cached.segments.assign(m_segmentRefs.begin(), m_segmentRefs.end());
+			if (p_func.segmentCallback)
+				return;
+
+			if (p_cached.consts.empty() and p_cached.slots.empty()) {
+				p_cached.segments.clear();
+
+				return;
+			};
 
-				throw CompilerException(
-						ExpectedErrorMsg("size specifier", currTokName),
-						m_it->line, m_it->col
-					);
-			} else {
-				-- m_it;
-				return p_default;
+			m_params.resize(m_frameBegin);
+			AddCached(p_cached);
+			if (not p_cached.slots.empty()) {
+				p_cached.params.assign(m_params.begin() + m_frameBegin, m_params.end());
+				p_cached.segments.clear();
 			};
 		};
 
-		bool IsSym(const char p_sym) {
-			if (m_it == m_tokens->cend())
-				return false;
+		// Appends the parameters of a cached call to m_params
+		void AddCached(const CachedCall &p_cached) {
+			if (p_cached.segments.empty()) {
+				m_params.insert(m_params.end(), p_cached.params.begin(), p_cached.params.end());
 
-			switch (m_it->type) {
-			case TokenType::Sym:
-				return std::get<char>(m_it->data) == p_sym;
+				return;
+			};
 
-			default: return false;
+			for (const SegmentRef &ref : p_cached.segments) {
+				const u8 *data = ref.data == nullptr? p_cached.params.data() + ref.offset : ref.data;
+				m_params.insert(m_params.end(), data, data + ref.size);
 			};
 		};
 
-		std::vector<Structcode> m_scode;
+		// Whether a call of p_func, using constants or not, can join the
+		// batch of p_batch
+		static bool CanBatch(const Func &p_batch, const Func &p_func, const bool p_consts) {
+			return &p_func == &p_batch and (p_batch.batchConsts or not p_consts);
+		};
 
-		const std::vector<Token> *m_tokens;
-		std::vector<Token>::const_iterator m_it;
+		// Calls the batch callback of p_first.func once for it and the
+		// calls of the function right after it which can join the batch
+		template <typename Statics>
+		void RunBatch(
+			ParamCache *p_cache,
+			usize &p_callCount,
+			const usize p_idx,
+			const PreparedCall &p_first
+		) {
+			const Func &func = *p_first.func;
 
-		Tools::ByteSJ m_byteSJ;
-	}; // class Compiler
+			// Parameters from the cache are not in m_params yet
+			if (p_first.params.Data() != m_params.data())
+				m_params.assign(p_first.params.begin(), p_first.params.end());
 
-	struct Func {
-	public:
-		Func() {};
+			m_batchEnds.clear();
+			m_batchEnds.push_back(m_params.size());
 
-		Func(const Callback &p_callback):
-			callback(p_callback)
-		{};
+			while (m_batchEnds.size() < MaxBatchFrames) {
+				// Where the next call starts again if it does not join
+				const auto  it  = m_it;
+				const usize idx = m_idx;
 
-		Callback callback;
-	}; // struct Func
+				Inc();
 
-	struct Const {
-	public:
-		static constexpr const u8 Size8b  = 1;
-		static constexpr const u8 Size16b = 2;
-		static constexpr const u8 Size32b = 4;
-		static constexpr const u8 Size64b = 8;
+				// Every frame starts aligned, like the parameters of a call
+				m_params.resize(Tools::AlignUp(m_params.size(), FrameAlign), 0);
 
-		Const() {};
+				PreparedCall call;
+				if (
+					m_it == m_scode->cend() or
+					m_it->type != StructcodeType::Id or
+					not PrepareCall(p_cache, p_callCount, &func, call)
+				) {
+					m_it  = it;
+					m_idx = idx;
+
+					// Without what was assembled of the call
+					m_params.resize(m_batchEnds.back());
+
+					break;
+				};
+
+				m_batchEnds.push_back(m_params.size());
+			};
 
-		Const(const u64 p_num, const u8 p_size = Size32b) {
-			Tools::ByteSJ byteSJ(value);
+			// The buffer only stops moving once all the frames are in
+			m_batchFrames.clear();
+			usize begin = 0;
+			for (const usize end : m_batchEnds) {
+				m_batchFrames.push_back(ParamView(m_params.data() + begin, end - begin));
+				begin = Tools::AlignUp(end, FrameAlign);
+			};
 
-			Split(p_num, p_size, byteSJ);
+			Call<Statics>(
+				func, p_idx, ParamView(), ParamSegments(),
+				ParamFrames(m_batchFrames.data(), m_batchFrames.size(), m_params.size())
+			);
 		};
 
-		Const(const std::string &p_str, const u8 p_size = Size8b) {
-			std::vector<u8> bytes;
-			Tools::ByteSJ byteSJ(bytes);
+		// Functions for shorter code
+
+		// Stores the error about the current structcode and returns false
+		bool Fail(const ErrorCode p_code) {
+			if (m_it == m_scode->cend())
+				m_error = Error(p_code, ErrorSubject::EndOfFile);
+			else {
+				switch (m_it->type) {
+				case StructcodeType::Int:
+				case StructcodeType::Align:
+				case StructcodeType::Arg:
+				case StructcodeType::Typed:
+					m_error = Error(p_code, ErrorSubject::Int);
+					m_error.num = std::get<u8>(m_it->data);
+					break;
+
+				case StructcodeType::Id:
+					m_error = Error(p_code, ErrorSubject::Id, std::get<std::pmr::string>(m_it->data));
+					break;
 
-			for (const char ch : p_str) {
-				Split(ch, p_size, byteSJ);
+				case StructcodeType::Slot: {
+						const u8 slot = std::get<u8>(m_it->data);
+						m_error = Error(
+							p_code, ErrorSubject::Text,
+							m_bindings != nullptr and slot < m_bindings->GetCount()?
+								std::string(m_bindings->GetName(slot)) : std::to_string(slot)
+						);
+					};
 
-				for (const u8 byte : bytes)
-					value.push_back(byte);
+					break;
+				};
 			};
 
-			value.push_back(0); // Null terminator
+			m_error.idx = m_idx;
+
+			if (m_trace != nullptr and not m_traceDumpFile.empty())
+				DumpTrace(m_traceDumpFile);
+
+			return false;
 		};
 
-		Const(const std::vector<u8> p_list) {
-			value = p_list;
+		void Inc() {
+			++ m_it; ++ m_idx;
 		};
 
-	private:
-		void Split(
-			const u64 p_value,
-			const u8 p_size,
-			Tools::ByteSJ &p_byteSJ
+		// Resolves the segments into views, bytes from the code are in p_params
+		ParamSegments Segments(
+			const std::pmr::vector<SegmentRef> &p_refs,
+			const std::pmr::vector<u8> &p_params
 		) {
-			switch (p_size) {
-			case Size8b:
-				p_byteSJ.GetList() = {static_cast<u8>(p_value)};
-				break;
+			m_segments.clear();
 
-			case Size16b: p_byteSJ.Split16(p_value); break;
-			case Size32b: p_byteSJ.Split32(p_value); break;
-			case Size64b: p_byteSJ.Split64(p_value); break;
+			usize bytes = 0;
+			for (const SegmentRef &ref : p_refs) {
+				m_segments.push_back(ParamView(
+					ref.data == nullptr? p_params.data() + ref.offset : ref.data,
+					ref.size
+				));
 
-			default:
-				throw Exception(
-						"Invalid amount of bytes: " +
-						std::to_string(p_size)
-					);
+				bytes += ref.size;
 			};
+
+			return ParamSegments(m_segments.data(), m_segments.size(), bytes);
 		};
 
-	public:
-		std::vector<u8> value;
-	}; // struct Const
+		// Calls the batch callback with p_frames or the segment callback
+		// with p_segments if the function has one, otherwise the callback
+		// with p_params
+		template <typename Statics>
+		void Call(
+			const Func &p_func,
+			const usize p_idx,
+			const ParamView p_params,
+			const ParamSegments p_segments,
+			const ParamFrames p_frames = ParamFrames()
+		) {
+			const usize size =
+				p_func.batchCallback?   p_frames.Bytes() :
+				p_func.segmentCallback? p_segments.Bytes() : p_params.Size();
+			if (size > m_runPeakParams) {
+				m_runPeakParams = size;
+				if (m_runPeakParams > m_peakParams)
+					m_peakParams = m_runPeakParams;
+			};
 
-	class Environment {
-	public:
-		Environment() {};
+			if (m_trace == nullptr)
+				Invoke<Statics>(p_func, p_params, p_segments, p_frames);
+			else {
+				TraceEvent event;
+				event.idx    = p_idx;
+				event.func   = p_func.slot;
+				event.params = size;
+				event.start  = TraceBuffer::Now();
 
-		Environment(const std::vector<Structcode> &p_scode) {
-			Run(p_scode);
+				Invoke<Statics>(p_func, p_params, p_segments, p_frames);
+
+				const u64 duration = TraceBuffer::Now() - event.start;
+				event.duration = duration > 0xFFFFFFFF? 0xFFFFFFFF : duration;
+
+				m_trace->Record(event);
+			};
 		};
 
-		void Run(const std::vector<Structcode> &p_scode) {
-			m_idx = 0;
+		template <typename Statics>
+		void Invoke(
+			const Func &p_func,
+			const ParamView p_params,
+			const ParamSegments p_segments,
+			const ParamFrames p_frames
+		) {
+			if (Statics::Any and p_func.staticIdx != Func::Dynamic)
+				Statics::Dispatch(*this, p_func.staticIdx, p_params);
+			else if (p_func.pure)
+				CallPure(p_func, p_params);
+			else if (p_func.batchCallback)
+				p_func.batchCallback(p_frames, m_userData);
+			else if (p_func.segmentCallback)
+				p_func.segmentCallback(p_segments, m_userData);
+			else
+				p_func.callback(p_params, m_userData);
+		};
 
-			m_scode = &p_scode;
-			for (
-				m_it = p_scode.cbegin();
-				m_it != p_scode.cend();
-				Inc()
-			) {
+		void Dec() {
+			-- m_it; -- m_idx;
+		};
+
+		// Records the constants and slot values used in p_cached with their
+		// version. If p_segments is not nullptr, constants are added to it
+		// instead of being copied into the parameters
+		bool GetParams(CachedCall *p_cached, std::pmr::vector<SegmentRef> *p_segments) {
+			usize literal = m_frameBegin; // Start of the bytes from the code not in p_segments yet
+			usize segments = 0; // Size of the constants in p_segments
+
+			m_args.clear();
+			m_padEnd  = 0;
+			m_padSize = 0;
+
+			for (; m_it != m_scode->cend(); Inc()) {
 				switch (m_it->type) {
+				case StructcodeType::Int:
+					m_params.push_back(std::get<u8>(m_it->data));
+					break;
+
+				case StructcodeType::Align:
+					Pad(std::get<u8>(m_it->data), segments);
+					break;
+
+				case StructcodeType::Arg: {
+						const u8 tag = std::get<u8>(m_it->data);
+						AddArg(static_cast<ArgKind>(tag & 0xF), tag >> 4, segments);
+					};
+
+					break;
+
+				case StructcodeType::Typed:
+					// A program joined after this one
+					Dec();
+					EndParams(p_segments, literal, segments);
+
+					return true;
+
 				case StructcodeType::Id: {
-						const std::string id = std::get<std::string>(m_it->data);
-						if (not m_funcs.count(id))
-							throw RuntimeException(
-									"No function with " +
-									GetCurrScodeName() +
-									" exists",
-									m_idx
-								);
+						const std::pmr::string &id = std::get<std::pmr::string>(m_it->data);
+						const SymbolTable::Symbol *symbol = FindSymbol(id);
+						if (symbol != nullptr and symbol->func != nullptr) {
+							Dec();
+							EndParams(p_segments, literal, segments);
 
-						const Func &func = m_funcs[id];
+							return true;
+						};
 
-						m_params.clear();
-						Inc();
-						GetParams();
+						Const *constant = symbol == nullptr? nullptr : symbol->constant;
+
+						// The call starts a new batch, which reports the error
+						if (m_batch != nullptr and (constant == nullptr or not m_batch->batchConsts))
+							return false;
+
+						if (constant == nullptr) {
+							return Fail(ErrorCode::NoSuchConst);
+						};
+
+						if (constant->producer)
+							Produce(*constant);
 
-						func.callback(m_params, m_userData);
+						AddConst(*constant, p_segments, literal, segments);
+						if (p_cached != nullptr)
+							p_cached->consts.push_back({constant, constant->version});
 					};
 
 					break;
 
-				default:
-					throw RuntimeException(
-							UnexpectedErrorMsg(GetCurrScodeName()),
-							m_idx
-						);
+				case StructcodeType::Slot: {
+						const u8 slot = std::get<u8>(m_it->data);
+						const Const *value = m_bindings == nullptr? nullptr : m_bindings->Get(slot);
+
+						// Like constants, the values are not batched
+						if (m_batch != nullptr and (value == nullptr or not m_batch->batchConsts))
+							return false;
+
+						if (value == nullptr)
+							return Fail(ErrorCode::UnboundSlot);
+
+						AddConst(*value, p_segments, literal, segments);
+						if (p_cached != nullptr)
+							p_cached->slots.push_back({slot, value->version});
+					};
+
+					break;
 				};
 			};
+
+			Dec();
+			EndParams(p_segments, literal, segments);
+
+			return true;
 		};
 
-		void SetUserData(void* p_userData) {
-			m_userData = p_userData;
+		// Copies the bytes of the constant into the parameters, or adds them
+		// to p_segments if it is not nullptr. p_constBytes is the size of
+		// the constants in p_segments
+		void AddConst(
+			const Const &p_const,
+			std::pmr::vector<SegmentRef> *p_segments,
+			usize &p_literal,
+			usize &p_constBytes
+		) {
+			const ParamView bytes = m_typed?
+				AddConstArg(p_const, p_constBytes) :
+				(Pad(p_const.align, p_constBytes), p_const.Bytes());
+
+			if (p_segments == nullptr)
+				m_params.insert(m_params.end(), bytes.begin(), bytes.end());
+			else {
+				AddLiteral(p_segments, p_literal);
+				if (not bytes.Empty())
+					p_segments->push_back({bytes.Data(), 0, bytes.Size()});
+
+				p_constBytes += bytes.Size();
+			};
 		};
 
-		void* GetUserData() {
-			return m_userData;
+		// Size of the parameters of the call, with the p_segments bytes of
+		// constants which are not in m_params
+		usize ParamsSize(const usize p_segments) const {
+			return m_params.size() - m_frameBegin + p_segments;
 		};
 
-		void SetFunc(
-			const std::string &p_name,
-			const Func &p_func
-		) {
-			if (not CheckName(p_name))
-				throw Exception(
-						"Invalid characters in function name '" +
-						p_name + "'"
-					);
+		// Pads the parameters with zeros to a multiple of p_align, counting
+		// the p_segments bytes of constants which are not in them
+		void Pad(const u8 p_align, const usize p_segments) {
+			if (p_align <= 1)
+				return;
 
-			if (m_consts.count(p_name))
-				throw Exception(
-						"Constant with the name '" +
-						p_name + "' already exists"
-					);
+			const usize size    = ParamsSize(p_segments);
+			const usize padding = Tools::AlignUp(size, p_align) - size;
+			m_params.resize(m_params.size() + padding, 0);
+
+			// Padding right before an argument is not a part of the one
+			// before it
+			if (size != m_padEnd)
+				m_padSize = 0;
 
-			m_funcs[p_name] = p_func;
+			m_padSize += padding;
+			m_padEnd   = size + padding;
 		};
 
-		void SetConst(
-			const std::string &p_name,
-			const Const &p_const
-		) {
-			if (not CheckName(p_name))
-				throw Exception(
-						"Invalid characters in function name '" +
-						p_name + "'"
-					);
+		// Ends the last argument of typed parameters and starts a new one
+		void AddArg(const ArgKind p_kind, const u8 p_width, const usize p_segments) {
+			EndArg(p_segments);
 
-			if (m_funcs.count(p_name))
-				throw Exception(
-						"Function with the name '" +
-						p_name + "' already exists"
-					);
+			ArgDesc desc = {};
+			desc.offset = ParamsSize(p_segments);
+			desc.kind   = p_kind;
+			desc.width  = p_width;
 
-			m_consts[p_name] = p_const;
+			m_args.push_back(desc);
 		};
 
-		std::unordered_map<std::string, Func> &GetFuncs() {
-			return m_funcs;
-		};
+		void EndArg(const usize p_segments) {
+			if (m_args.empty())
+				return;
 
-		void SetFuncs(std::unordered_map<std::string, Func> p_funcs) {
-			m_funcs = p_funcs;
-		};
+			usize end = ParamsSize(p_segments);
+			if (end == m_padEnd)
+				end -= m_padSize;
 
-		std::unordered_map<std::string, Const> &GetConsts() {
-			return m_consts;
+			m_args.back().size = end - m_args.back().offset;
 		};
 
-		void SetConsts(std::unordered_map<std::string, Const> p_consts) {
-			m_consts = p_consts;
-		};
+		// Adds the constant as an argument of typed parameters, returns
+		// the bytes to pass. Strings get their length instead of the
+		// null terminator
+		ParamView AddConstArg(const Const &p_const, const usize p_segments) {
+			const ParamView bytes = p_const.Bytes();
+			if (p_const.kind != ArgKind::Str or p_const.width == 0) {
+				Pad(p_const.align, p_segments);
+				AddArg(p_const.kind, p_const.width, p_segments);
 
-	private:
-		// Functions for shorter code
-		std::string GetCurrScodeName() {
-			if (m_it == m_scode->cend())
-				return "end of file";
+				return bytes;
+			};
 
-			switch (m_it->type) {
-			case StructcodeType::Int:
-				return (std::string)
-					"number " + std::to_string(std::get<u8>(m_it->data));
+			const bool native = m_argLayout == Layout::Native;
+			const usize length = bytes.Empty()? 0 : (bytes.Size() - 1) / p_const.width;
 
-			case StructcodeType::Id:
-				return (std::string)
-					"identifier '" + std::get<std::string>(m_it->data) + "'";
+			Pad(native? 4 : 1, p_segments);
+			AddArg(ArgKind::Str, p_const.width, p_segments);
 
-			default: return "UNKNOWN";
+			u8 prefix[4];
+			if (native)
+				Tools::StoreNative(length, 4, prefix);
+			else {
+				for (u8 i = 0; i < 4; ++ i)
+					prefix[i] = static_cast<u8>(length >> ((3 - i) * 010));
 			};
-		};
 
-		void Inc() {
-			++ m_it; ++ m_idx;
-		};
+			m_params.insert(m_params.end(), prefix, prefix + 4);
+			Pad(native? p_const.width : 1, p_segments);
 
-		void Dec() {
-			-- m_it; -- m_idx;
+			return ParamView(bytes.Data(), length * p_const.width);
 		};
 
-		void GetParams() {
-			std::string id;
-			for (; m_it != m_scode->cend(); Inc()) {
-				switch (m_it->type) {
-				case StructcodeType::Int:
-					m_params.push_back(std::get<u8>(m_it->data));
-					break;
-
-				case StructcodeType::Id:
-					id = std::get<std::string>(m_it->data);
-					if (m_funcs.count(id)) {
-						Dec();
-						return;
-					};
+		// Ends the parameters of a call, typed ones with their argument
+		// table. p_constBytes is the size of the constants in p_segments
+		void EndParams(
+			std::pmr::vector<SegmentRef> *p_segments,
+			usize &p_literal,
+			const usize p_constBytes
+		) {
+			if (m_typed) {
+				EndArg(p_constBytes);
 
-					if (not m_consts.count(id))
-						throw RuntimeException(
-								"No constant with " +
-								GetCurrScodeName() +
-								" exists",
-								m_idx
-							);
+				const usize size  = m_params.size();
+				const usize table = m_args.size() * sizeof(ArgDesc);
+				m_params.resize(size + table + 4);
+				if (table > 0)
+					std::memcpy(m_params.data() + size, m_args.data(), table);
 
-					for (const u8 byte : m_consts[id].value)
-						m_params.push_back(byte);
-				};
+				Tools::StoreNative(m_args.size(), 4, m_params.data() + size + table);
 			};
 
-			Dec();
+			AddLiteral(p_segments, p_literal);
+		};
+
+		// Adds the bytes from the code since p_literal as a segment
+		void AddLiteral(std::pmr::vector<SegmentRef> *p_segments, usize &p_literal) {
+			if (p_segments == nullptr or p_literal == m_params.size())
+				return;
+
+			p_segments->push_back({nullptr, p_literal - m_frameBegin, m_params.size() - p_literal});
+			p_literal = m_params.size();
 		};
 
-		bool CheckName(const std::string& p_name) {
+	protected:
+		static constexpr bool CheckName(const std::string_view p_name) {
 			for (const char ch : p_name) {
 				switch (ch) {
 				case SCBL_NAME_CHARS:
@@ -1204,18 +5404,167 @@ namespace SCBL {
 			return true;
 		};
 
-		std::vector<u8> m_params;
+	private:
+		std::pmr::vector<u8> m_params;
+
+		// Parameters of segment callbacks
+		std::pmr::vector<SegmentRef> m_segmentRefs;
+		std::pmr::vector<ParamView>  m_segments;
+
+		// Arguments of typed parameters
+		std::pmr::vector<ArgDesc> m_args;
+
+		// Frames of batch callbacks, one after another in m_params
+		std::pmr::vector<usize>     m_batchEnds;
+		std::pmr::vector<ParamView> m_batchFrames;
+
+		const Func *m_batch; // Function of the batch a call is prepared for
+		const Bindings *m_bindings; // Values of the slots of the code being run
+		usize m_frameBegin;  // Start of the parameters of the call in m_params
+
+		FuncMap m_funcs;
+		ConstMap m_consts;
+
+		std::pmr::vector<std::pmr::string> m_funcNames;
+
+		// Index of both maps, changed together with them
+		SymbolTable m_symbols;
+
+		std::pmr::vector<ParamCache> m_paramCaches;
+
+		// Constants of the registers in m_consts, by their index
+		std::pmr::vector<Const*> m_registers;
+		std::pmr::vector<std::pmr::string> m_registerNames;
+
+		// Programs kept by Eval, the index views the code in the list
+		ProgramList m_programs;
+		std::pmr::unordered_map<std::string_view, ProgramList::iterator> m_programIdx;
+
+		Lexer m_evalLexer;
+		std::string m_evalCode;
+
+		usize m_evalCapacity, m_evalBytes;
+		u64   m_evalHits, m_evalMisses;
+
+		// Calls of pure functions by their slot and parameters
+		std::pmr::unordered_map<std::pmr::string, MemoEntry> m_memo;
+		std::pmr::string m_memoKey;
+		Effects m_effects; // Of the pure function being called
+
+		usize m_memoCapacity;
+		u64   m_memoHits, m_memoMisses;
+		bool  m_recording;
+
+		std::unique_ptr<TraceBuffer> m_trace;
+		std::string m_traceDumpFile;
 
-		std::unordered_map<std::string, Func> m_funcs;
-		std::unordered_map<std::string, Const> m_consts;
+		Output m_output;
+
+		u64 m_constVersion; // Last version given to a constant
+		u64 m_cacheEpoch;   // Changes when a function was replaced or removed, or a map was replaced
+		u64 m_runs;
+		u64 m_run;       // Number of the current run, for lazy constants
+		usize m_callIdx; // Index of the call being prepared
+
+		usize m_constBytes; // Size of all the constant values
+		usize m_peakParams, m_runPeakParams, m_runPeakConsts;
+		usize m_padEnd, m_padSize; // Logical end and size of the last padding
+
+		bool m_typed; // The code being run is typed
+		Layout m_argLayout;
 
 		usize m_idx;
 
-		const std::vector<Structcode> *m_scode;
-		std::vector<Structcode>::const_iterator m_it;
+		const std::pmr::vector<Structcode> *m_scode;
+		std::pmr::vector<Structcode>::const_iterator m_it;
 
 		void* m_userData;
+		Error m_error;
+
+		// ExecuteWith the functions of a StaticEnvironment, nullptr in others
+		Error (Environment::*m_execute)(const std::pmr::vector<Structcode>&, ParamCache*);
 	}; // class Environment
+
+	// An environment with a set of functions known when compiling. Each of
+	// Fns is a type with a Name and a static Call(ParamView, Context&).
+	// The code is run with ExecuteWith<StaticEnvironment>, which calls
+	// them directly with the context instead of through a std::function
+	// with the user data. Functions set with SetFunc still work, and
+	// replace a static one of the same name
+	template <typename Context, typename... Fns>
+	class StaticEnvironment: public Environment {
+		// Its ExecuteWith calls Dispatch
+		friend class Environment;
+
+	public:
+		static constexpr const usize FuncCount = sizeof...(Fns);
+		static constexpr const bool  Any       = FuncCount > 0;
+
+		// The context is the user data too, for the other functions
+		StaticEnvironment(
+			Context &p_context,
+			std::pmr::memory_resource *p_resource = std::pmr::get_default_resource()
+		):
+			Environment(p_resource),
+			m_context(&p_context)
+		{
+			SetUserData(static_cast<void*>(&p_context));
+			m_execute = &Environment::ExecuteWith<StaticEnvironment>;
+
+			for (usize i = 0; i < FuncCount; ++ i) {
+				Func func;
+				func.staticIdx = i;
+				TrySetFunc(std::string(Names[i]), func);
+			};
+		};
+
+		Context &GetContext() {
+			return *m_context;
+		};
+
+	private:
+		static constexpr const std::array<std::string_view, FuncCount> Names = {{Fns::Name...}};
+
+		static constexpr bool CheckNames() {
+			for (const std::string_view name : Names) {
+				if (not CheckName(name))
+					return false;
+			};
+
+			return true;
+		};
+
+		static constexpr bool CheckUnique() {
+			for (usize i = 0; i < FuncCount; ++ i) {
+				for (usize j = i + 1; j < FuncCount; ++ j) {
+					if (Names[i] == Names[j])
+						return false;
+				};
+			};
+
+			return true;
+		};
+
+		static_assert(CheckUnique(), "The names of the static functions have to be different");
+		static_assert(CheckNames(), "Invalid characters in the name of a static function");
+
+		// Compares the index with constants, which compilers turn into a
+		// switch, and the Calls are inlined into it
+		template <usize... Idx>
+		static void Call(Context &p_context, const u32 p_idx, const ParamView p_params, std::index_sequence<Idx...>) {
+			(void)((p_idx == Idx? (Fns::Call(p_params, p_context), true) : false) or ...);
+		};
+
+		static void Dispatch(Environment &p_env, const u32 p_idx, const ParamView p_params) {
+			Call(
+				*static_cast<StaticEnvironment&>(p_env).m_context,
+				p_idx, p_params,
+				std::index_sequence_for<Fns...>()
+			);
+		};
+
+		Context *m_context;
+	}; // class StaticEnvironment
 }; // namespace SCBL
 
 #endif // __SCBL_HH_HEADER_GUARD__
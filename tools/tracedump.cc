@@ -0,0 +1,109 @@
+#include <iostream> // std::cout, std::cerr
+#include <fstream> // std::ifstream
+#include <string> // std::string
+#include <vector> // std::vector
+#include <scbl.hh> // SCBL::TraceBuffer, SCBL::u8, SCBL::u32, SCBL::u64, SCBL::usize
+
+/*
+ *  SCBL trace decoder
+ *
+ *  Prints a trace dumped by SCBL::Environment::DumpTrace as CSV,
+ *  one row per function call from the oldest:
+ *
+ *    seq,start,duration,idx,func,params
+ *
+ *  start is relative to the first event, start and duration are in
+ *  nanoseconds or CPU cycles depending on the clock of the trace.
+ */
+
+using SCBL::u8;
+using SCBL::u32;
+using SCBL::u64;
+using SCBL::usize;
+
+static bool Read(std::istream &p_stream, u64 &p_value, const u8 p_size) {
+	unsigned char bytes[8];
+	if (not p_stream.read(reinterpret_cast<char*>(bytes), p_size))
+		return false;
+
+	p_value = 0;
+	for (u8 i = 0; i < p_size; ++ i)
+		p_value |= static_cast<u64>(bytes[i]) << (i * 010);
+
+	return true;
+};
+
+static int Fail(const std::string &p_file, const char *p_msg) {
+	std::cerr << "tracedump: " << p_file << ": " << p_msg << std::endl;
+
+	return 1;
+};
+
+int main(const int argc, const char *argv[]) {
+	if (argc != 2) {
+		std::cerr << "Usage: tracedump FILE" << std::endl;
+
+		return 1;
+	};
+
+	const std::string file = argv[1];
+	std::ifstream stream(file, std::ios::binary);
+	if (not stream.is_open())
+		return Fail(file, "Could not open the file");
+
+	char magic[8];
+	if (not stream.read(magic, 8) or std::string(magic, 8) != SCBL::TraceBuffer::Magic)
+		return Fail(file, "Not an SCBL trace");
+
+	u64 clock, recorded, count;
+	if (not Read(stream, clock, 4) or not Read(stream, recorded, 8) or not Read(stream, count, 4))
+		return Fail(file, "Truncated header");
+
+	std::vector<std::string> names;
+	for (u64 i = 0; i < count; ++ i) {
+		u64 length;
+		if (not Read(stream, length, 4))
+			return Fail(file, "Truncated name table");
+
+		std::string name(length, '\0');
+		if (not stream.read(&name[0], length))
+			return Fail(file, "Truncated name table");
+
+		names.push_back(name);
+	};
+
+	if (not Read(stream, count, 4))
+		return Fail(file, "Truncated event count");
+
+	std::cout
+		<< "# clock: " << (clock == SCBL::TraceBuffer::ClockTSC? "tsc cycles" : "steady nanoseconds")
+		<< ", recorded: " << recorded
+		<< ", kept: " << count << "\n"
+		<< "seq,start,duration,idx,func,params\n";
+
+	u64 first = 0;
+	for (u64 i = 0; i < count; ++ i) {
+		u64 start, duration, idx, func, params;
+		if (
+			not Read(stream, start,    8) or
+			not Read(stream, duration, 4) or
+			not Read(stream, idx,      4) or
+			not Read(stream, func,     4) or
+			not Read(stream, params,   4)
+		)
+			return Fail(file, "Truncated events");
+
+		if (i == 0)
+			first = start;
+
+		std::cout
+			<< recorded - count + i << ","
+			<< start - first << ","
+			<< duration << ","
+			<< idx << ","
+			<< (func < names.size()? names[func] : "?" + std::to_string(func)) << ","
+			<< params << "\n";
+	};
+
+	return 0;
+};